@@ -2,7 +2,7 @@
 #ifndef VIEWER_MESH_5872C703_91C0_48F0_AB16_333F916F9FF4
 #define VIEWER_MESH_5872C703_91C0_48F0_AB16_333F916F9FF4
 
-// Contains definitions of Mesh, PointCloud, and Line
+// Contains definitions of Mesh, MeshGroup, PointCloud, and Line
 
 #include <vector>
 #include <array>
@@ -14,6 +14,7 @@
 #include "meshview/texture.hpp"
 #include "meshview/shader.hpp"
 #include "meshview/camera.hpp"
+#include "meshview/util.hpp"
 
 namespace meshview {
 
@@ -36,9 +37,10 @@ public:
     // Draw mesh to shader wrt camera
     void draw(const Shader& shader, const Camera& camera);
 
-    // Compute normals automatically from verts_pos
+    // Compute area-weighted normals automatically from verts_pos
     // usage: first set vertex positions using verts_pos()
     // then call estimate_normals()
+    // The vertex-face adjacency is cached and only rebuilt when faces change.
     Mesh& estimate_normals();
 
     // Add a texture from a file
@@ -78,23 +80,45 @@ public:
     // Set transform
     Mesh& set_transform(const Eigen::Ref<const Matrix4f>& mat);
 
+    // Hint that positions and normals will be modified often (e.g. every frame
+    // of an animation); applies when the buffers are created
+    Mesh& set_dynamic(bool val = true);
+
     // Init or update VAO/VBO/EBO buffers from current vertex and triangle data
     // Must called before first draw for each GLFW context to ensure
     // textures are reconstructed.
+    // After initialization, only modified vertex streams are written into
+    // their existing VBOs; faces are re-uploaded only if they changed since
+    // the last upload, and textures are only loaded once.
     void update(bool force_init = false);
 
     // ADVANCED: Free buffers. Used automatically in destructor.
     void free_bufs();
 
     // *Accessors
-    // Position part of verts
-    inline Eigen::Ref<Points> verts_pos() { return verts.leftCols<3>(); }
+    // Vertex attributes are stored (and uploaded) as separate streams;
+    // the non-const accessors mark their stream as modified, so that
+    // update() only re-uploads the streams accessed since the last update
+    // Vertex positions, shape (num_verts, 3)
+    inline Eigen::Ref<Points> verts_pos() {
+        stream_dirty[STREAM_POS] = true;
+        return pos;
+    }
+    inline const Points& verts_pos() const { return pos; }
 
-    // UV part of verts
-    inline Eigen::Ref<Points2D> verts_uv() { return verts.middleCols<2>(3); }
+    // UV coordinates, shape (num_verts, 2)
+    inline Eigen::Ref<Points2D> verts_uv() {
+        stream_dirty[STREAM_UV] = true;
+        return uv;
+    }
+    inline const Points2D& verts_uv() const { return uv; }
 
-    // Normal part of verts
-    inline Eigen::Ref<Points> verts_norm() { return verts.rightCols<3>(); }
+    // Vertex normals, shape (num_verts, 3)
+    inline Eigen::Ref<Points> verts_norm() {
+        stream_dirty[STREAM_NORM] = true;
+        return norm;
+    }
+    inline const Points& verts_norm() const { return norm; }
 
     // Enable/disable object
     Mesh& enable(bool val = true);
@@ -115,12 +139,6 @@ public:
     // num_triangles: # triangles, -1 if not using EBO
     const size_t num_verts, num_triangles;
 
-    // Shape (num_verts, 8)
-    // 3 x vertex position
-    // 2 x uv
-    // 3 x normal
-    PointsUVN verts;
-
     // Shape (num_triangles, 3)
     // Triangle indices, empty if num_triangles = -1 (not using EBO)
     Triangles faces;
@@ -138,15 +156,204 @@ public:
     Matrix4f transform;
 
 private:
-    // Generate a white 1x1 texture to blank_tex_id
-    // used to fill maps if no texture provided
-    void gen_blank_texture();
-
     // Vertex Array Object index
     Index VAO = -1;
 
-    Index VBO = -1, EBO = -1;
+    // Vertex attribute streams, in order of attribute location
+    enum {
+        STREAM_POS,
+        STREAM_UV,
+        STREAM_NORM,
+        __STREAM_COUNT
+    };
+
+    // Vertex positions, uv coordinates, normals; see verts_pos() etc.
+    Points pos;
+    Points2D uv;
+    Points norm;
+
+    // Whether each stream was modified since its last upload
+    std::array<bool, __STREAM_COUNT> stream_dirty;
+
+    // One VBO per stream
+    std::array<Index, __STREAM_COUNT> VBO;
+    Index EBO = -1;
+    Index blank_tex_id = -1;
+
+    // Whether to allocate position/normal VBOs for frequent updates,
+    // see set_dynamic
+    bool dynamic = false;
+
+    // Faces in the EBO, to skip uploading unchanged faces
+    Triangles uploaded_faces;
+
+    // Cached adjacency for estimate_normals
+    util::NormalEstimator normal_estimator;
+};
+
+// Represents a group of triangle meshes ('instances') sharing one topology,
+// uv coordinates, material, and transform, e.g. a crowd of bodies.
+// Each instance has its own vertex positions and normals; all instances are
+// stored in one VBO per attribute and share one EBO and VAO, so that the
+// whole group is drawn in a single call.
+class MeshGroup {
+public:
+    // Construct with num_instances copies of the mesh given by pos and faces
+    // pos: initial positions of each instance, shape (num_verts, 3)
+    // tri_faces: shared triangles, shape (num_triangles, 3)
+    // uv: shared uv coordinates (optional), shape (num_verts, 2)
+    explicit MeshGroup(size_t num_instances,
+                       const Eigen::Ref<const Points>& pos,
+                       const Eigen::Ref<const Triangles>& tri_faces,
+                       const Eigen::Ref<const Points2D>& uv = Points2D());
+    ~MeshGroup();
+
+    // Draw all instances to shader wrt camera
+    void draw(const Shader& shader, const Camera& camera);
+
+    // Compute area-weighted normals of every instance from verts_pos
+    MeshGroup& estimate_normals();
+
+    // Add a texture from a file, shared by all instances
+    template<int Type = Texture::TYPE_DIFFUSE>
+    MeshGroup& add_texture(const std::string& path) {
+        textures[Type].emplace_back(path, Type);
+        return *this;
+    }
+    // Add solid texture
+    template<int Type = Texture::TYPE_DIFFUSE>
+    MeshGroup& add_texture_solid(const Eigen::Ref<const Vector3f>& color) {
+        textures[Type].emplace_back(color, Type);
+        return *this;
+    }
+    template<int Type = Texture::TYPE_DIFFUSE>
+    MeshGroup& add_texture_solid(float r, float g, float b) {
+        textures[Type].emplace_back(Vector3f(r, g, b), Type);
+        return *this;
+    }
+
+    // Set specular shininess parameter
+    MeshGroup& set_shininess(float val);
+
+    // Apply translation
+    MeshGroup& translate(const Eigen::Ref<const Vector3f>& vec);
+
+    // Apply rotation
+    MeshGroup& rotate(const Eigen::Ref<const Matrix3f>& mat);
+
+    // Apply scaling
+    MeshGroup& scale(const Eigen::Ref<const Vector3f>& vec);
+    // Apply uniform scaling
+    MeshGroup& scale(float val);
+
+    // Set transform
+    MeshGroup& set_transform(const Eigen::Ref<const Matrix4f>& mat);
+
+    // Hint that positions and normals will be modified often,
+    // see Mesh::set_dynamic
+    MeshGroup& set_dynamic(bool val = true);
+
+    // Init or update VAO/VBO/EBO buffers, see Mesh::update.
+    // After initialization, only the positions/normals of instances
+    // accessed since the last update are written (consecutive instances
+    // in one write).
+    void update(bool force_init = false);
+
+    // ADVANCED: Free buffers. Used automatically in destructor.
+    void free_bufs();
+
+    // *Accessors
+    // The non-const accessors mark the instance's data as modified,
+    // see Mesh::verts_pos()
+    // Vertex positions of instance i, shape (num_verts, 3)
+    inline Eigen::Ref<Points> verts_pos(size_t i) {
+        pos_dirty[i] = true;
+        return pos.middleRows(i * num_verts, num_verts);
+    }
+    inline Eigen::Ref<const Points> verts_pos(size_t i) const {
+        return pos.middleRows(i * num_verts, num_verts);
+    }
+
+    // Vertex normals of instance i, shape (num_verts, 3)
+    inline Eigen::Ref<Points> verts_norm(size_t i) {
+        norm_dirty[i] = true;
+        return norm.middleRows(i * num_verts, num_verts);
+    }
+    inline Eigen::Ref<const Points> verts_norm(size_t i) const {
+        return norm.middleRows(i * num_verts, num_verts);
+    }
+
+    // UV coordinates shared by all instances, shape (num_verts, 2)
+    inline Eigen::Ref<Points2D> verts_uv() {
+        uv_dirty = true;
+        return uv;
+    }
+    inline const Points2D& verts_uv() const { return uv; }
+
+    // Enable/disable object
+    MeshGroup& enable(bool val = true);
+
+    // * Per-group constants
+    // num_instances: # meshes in the group
+    // num_verts: # verts per instance
+    // num_triangles: # triangles per instance
+    const size_t num_instances, num_verts, num_triangles;
+
+    // Shape (num_triangles, 3)
+    // Triangle indices shared by all instances
+    Triangles faces;
+
+    // Whether this group is enabled; if false, does not draw anything
+    bool enabled = true;
+
+    // Textures
+    std::array<std::vector<Texture>, Texture::__TYPE_COUNT> textures;
+
+    // Shininess
+    float shininess = 32.f;
+
+    // Model local transfom, shared by all instances
+    Matrix4f transform;
+
+private:
+    // Vertex attribute streams, in order of attribute location
+    enum {
+        STREAM_POS,
+        STREAM_UV,
+        STREAM_NORM,
+        __STREAM_COUNT
+    };
+
+    // Vertex positions, normals of all instances, shape
+    // (num_instances * num_verts, 3); uv of one instance (replicated on upload)
+    Points pos;
+    Points2D uv;
+    Points norm;
+
+    // Whether each instance's positions/normals were modified since the
+    // last upload; whether uv was modified
+    std::vector<char> pos_dirty, norm_dirty;
+    bool uv_dirty = true;
+
+    // Buffer indices
+    Index VAO = -1;
+    std::array<Index, __STREAM_COUNT> VBO;
+    Index EBO = -1;
     Index blank_tex_id = -1;
+
+    // See set_dynamic
+    bool dynamic = false;
+
+    // Faces in the EBO, to skip uploading unchanged faces
+    Triangles uploaded_faces;
+
+    // Per-instance arguments to the multi-draw call:
+    // index counts, index offsets (all 0), base vertices
+    std::vector<int> draw_counts, draw_base_verts;
+    std::vector<const void*> draw_indices;
+
+    // Cached adjacency for estimate_normals
+    util::NormalEstimator normal_estimator;
 };
 
 // Represents a 3D point cloud with vertices (including uv, normals)
@@ -3,6 +3,7 @@
 #define VIEWER_UTIL_67A492E2_6CCA_4FA8_9763_90A5DA4F6837
 
 #include <string>
+#include <vector>
 #include "common.hpp"
 
 namespace meshview {
@@ -38,6 +39,41 @@ void estimate_normals(const Eigen::Ref<const Points>& verts,
 void estimate_normals(const Eigen::Ref<const Points>& verts,
                       Eigen::Ref<Points> out);
 
+// Area-weighted normal estimation for meshes with fixed topology.
+// The vertex-to-face adjacency (CSR) is built once in set_faces;
+// estimate() then computes unnormalized face normals (|n| = 2 * area)
+// and gathers them per vertex, so no two threads write the same vertex.
+// Large meshes are split across threads.
+class NormalEstimator {
+public:
+    NormalEstimator() = default;
+    // faces: triangles; num_verts: # verts (indices must be < num_verts)
+    NormalEstimator(const Eigen::Ref<const Triangles>& faces, size_t num_verts);
+
+    // Set topology, rebuilding the adjacency
+    void set_faces(const Eigen::Ref<const Triangles>& faces, size_t num_verts);
+
+    // Whether faces/num_verts equal the current topology
+    bool same_faces(const Eigen::Ref<const Triangles>& faces, size_t num_verts) const;
+
+    // Estimate normals of verts into out (same size as verts);
+    // vertices not in any face get zero normals
+    void estimate(const Eigen::Ref<const Points>& verts,
+                  Eigen::Ref<Points> out);
+
+    inline size_t num_verts() const { return _vert_face_begin.empty() ? 0 :
+                                             _vert_face_begin.size() - 1; }
+    inline size_t num_faces() const { return _faces.rows(); }
+
+private:
+    Triangles _faces;
+    // CSR adjacency: faces of vertex i are
+    // _vert_faces[_vert_face_begin[i] : _vert_face_begin[i + 1]]
+    std::vector<Index> _vert_face_begin, _vert_faces;
+    // Unnormalized face normals, shape (num_faces, 3)
+    Points _face_normals;
+};
+
 }  // namespace util
 }  // namespace meshview
 
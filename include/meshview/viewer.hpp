@@ -30,6 +30,9 @@ public:
     // Shorthand for adding mesh (to Viewer::meshes)
     Mesh& add(Mesh&& mesh);
     Mesh& add(const Mesh& mesh);
+    // Shorthand for adding mesh group (to Viewer::mesh_groups)
+    MeshGroup& add(MeshGroup&& mesh_group);
+    MeshGroup& add(const MeshGroup& mesh_group);
     // Shorthand for adding point_cloud (to Viewer::point_clouds)
     PointCloud& add(PointCloud&& mesh);
     PointCloud& add(const PointCloud& mesh);
@@ -40,6 +43,8 @@ public:
 
     // * The meshes
     std::vector<Mesh> meshes;
+    // * The mesh groups (many meshes with the same faces, e.g. a crowd)
+    std::vector<MeshGroup> mesh_groups;
     // * The point clouds
     std::vector<PointCloud> point_clouds;
 
@@ -44,5 +44,15 @@ enum class Gender {
     unknown, neutral, male, female
 };
 
+// Floating point storage precision
+enum class Precision {
+    fp32, fp16, bf16
+};
+
+// Blend shape memory layout, see Model::set_blend_shapes_layout
+enum class BlendShapesLayout {
+    column_major, tiled
+};
+
 }
 #endif  // ifndef SMPL_COMMON_4E758201_E767_4C0C_9E87_0F1A988E0FE1
@@ -0,0 +1,133 @@
+#pragma once
+#ifndef SMPLX_INTERNAL_BLEND_TILES_6A1F3D85_2B9C_4E07_93D4_C8E51F06A27B
+#define SMPLX_INTERNAL_BLEND_TILES_6A1F3D85_2B9C_4E07_93D4_C8E51F06A27B
+
+// Vertex-tiled blend shape layout (see Model::set_blend_shapes_layout) and
+// its matrix-vector kernel.
+// The (3*#verts, #blend shapes) column-major matrix is split into tiles of
+// BLEND_TILE_VERTS vertices; each tile stores its BLEND_TILE_ROWS rows of
+// every column contiguously (tile-major, then column, then row), with the
+// last tile zero-padded. A product over a tile then reads one contiguous
+// stream, keeping the tile's outputs in registers and writing them once.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+#include "smplx/defs.hpp"
+
+#if defined(__AVX512F__) || defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace smplx {
+namespace internal {
+
+constexpr size_t BLEND_TILE_VERTS = 16;
+constexpr size_t BLEND_TILE_ROWS = 3 * BLEND_TILE_VERTS;
+
+// Number of tiles for n_verts vertices
+constexpr size_t n_blend_tiles(size_t n_verts) {
+    return (n_verts + BLEND_TILE_VERTS - 1) / BLEND_TILE_VERTS;
+}
+
+// Pack the column-major (n_rows, n_cols) matrix src into tiles;
+// dst must hold n_blend_tiles(n_rows / 3) * n_cols * BLEND_TILE_ROWS values
+inline void pack_blend_tiles(const Scalar* src, size_t n_rows, size_t n_cols,
+        Scalar* dst) {
+    for (size_t row = 0; row < n_rows; row += BLEND_TILE_ROWS) {
+        const size_t tile_rows = std::min(BLEND_TILE_ROWS, n_rows - row);
+        for (size_t j = 0; j < n_cols; ++j, dst += BLEND_TILE_ROWS) {
+            std::memcpy(dst, src + j * n_rows + row, tile_rows * sizeof(Scalar));
+            std::fill(dst + tile_rows, dst + BLEND_TILE_ROWS, Scalar(0));
+        }
+    }
+}
+
+// out = base + tile.cols(col_begin, n_params) * params for one tile
+// tile: the tile's data, n_cols columns of BLEND_TILE_ROWS values
+// base, out: BLEND_TILE_ROWS values each; may be the same
+inline void blend_tile_gemv(const Scalar* tile, size_t col_begin, size_t n_params,
+        const Scalar* params, const Scalar* base, Scalar* out) {
+    const Scalar* a = tile + col_begin * BLEND_TILE_ROWS;
+    size_t j = 0;
+#if defined(__AVX512F__)
+    // 3 vectors of 16 per column; two sets of accumulators (even/odd columns)
+    // to hide FMA latency
+    __m512 acc0 = _mm512_loadu_ps(base), acc1 = _mm512_loadu_ps(base + 16),
+           acc2 = _mm512_loadu_ps(base + 32);
+    __m512 acc3 = _mm512_setzero_ps(), acc4 = _mm512_setzero_ps(),
+           acc5 = _mm512_setzero_ps();
+    for (; j + 2 <= n_params; j += 2, a += 2 * BLEND_TILE_ROWS) {
+        const __m512 p0 = _mm512_set1_ps(params[j]), p1 = _mm512_set1_ps(params[j + 1]);
+        acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a), p0, acc0);
+        acc1 = _mm512_fmadd_ps(_mm512_loadu_ps(a + 16), p0, acc1);
+        acc2 = _mm512_fmadd_ps(_mm512_loadu_ps(a + 32), p0, acc2);
+        acc3 = _mm512_fmadd_ps(_mm512_loadu_ps(a + 48), p1, acc3);
+        acc4 = _mm512_fmadd_ps(_mm512_loadu_ps(a + 64), p1, acc4);
+        acc5 = _mm512_fmadd_ps(_mm512_loadu_ps(a + 80), p1, acc5);
+    }
+    if (j < n_params) {
+        const __m512 p0 = _mm512_set1_ps(params[j]);
+        acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a), p0, acc0);
+        acc1 = _mm512_fmadd_ps(_mm512_loadu_ps(a + 16), p0, acc1);
+        acc2 = _mm512_fmadd_ps(_mm512_loadu_ps(a + 32), p0, acc2);
+    }
+    _mm512_storeu_ps(out, _mm512_add_ps(acc0, acc3));
+    _mm512_storeu_ps(out + 16, _mm512_add_ps(acc1, acc4));
+    _mm512_storeu_ps(out + 32, _mm512_add_ps(acc2, acc5));
+#elif defined(__AVX__)
+    // 6 vectors of 8 per column, even/odd column accumulators as above
+#if defined(__FMA__)
+#define SMPLX_FMADD_PS(a, b, c) _mm256_fmadd_ps(a, b, c)
+#else
+#define SMPLX_FMADD_PS(a, b, c) _mm256_add_ps(_mm256_mul_ps(a, b), c)
+#endif
+    __m256 acc[6], acc_odd[6];
+    for (int k = 0; k < 6; ++k) {
+        acc[k] = _mm256_loadu_ps(base + 8 * k);
+        acc_odd[k] = _mm256_setzero_ps();
+    }
+    for (; j + 2 <= n_params; j += 2, a += 2 * BLEND_TILE_ROWS) {
+        const __m256 p0 = _mm256_set1_ps(params[j]), p1 = _mm256_set1_ps(params[j + 1]);
+        for (int k = 0; k < 6; ++k) {
+            acc[k] = SMPLX_FMADD_PS(_mm256_loadu_ps(a + 8 * k), p0, acc[k]);
+            acc_odd[k] = SMPLX_FMADD_PS(_mm256_loadu_ps(a + BLEND_TILE_ROWS + 8 * k), p1,
+                    acc_odd[k]);
+        }
+    }
+    if (j < n_params) {
+        const __m256 p0 = _mm256_set1_ps(params[j]);
+        for (int k = 0; k < 6; ++k) {
+            acc[k] = SMPLX_FMADD_PS(_mm256_loadu_ps(a + 8 * k), p0, acc[k]);
+        }
+    }
+#undef SMPLX_FMADD_PS
+    for (int k = 0; k < 6; ++k) {
+        _mm256_storeu_ps(out + 8 * k, _mm256_add_ps(acc[k], acc_odd[k]));
+    }
+#elif defined(__ARM_NEON)
+    // 12 vectors of 4 per column
+    float32x4_t acc[12];
+    for (int k = 0; k < 12; ++k) acc[k] = vld1q_f32(base + 4 * k);
+    for (; j < n_params; ++j, a += BLEND_TILE_ROWS) {
+        const float32x4_t p = vdupq_n_f32(params[j]);
+        for (int k = 0; k < 12; ++k) acc[k] = vmlaq_f32(acc[k], vld1q_f32(a + 4 * k), p);
+    }
+    for (int k = 0; k < 12; ++k) vst1q_f32(out + 4 * k, acc[k]);
+#else
+    Scalar acc[BLEND_TILE_ROWS];
+    std::copy(base, base + BLEND_TILE_ROWS, acc);
+    for (; j < n_params; ++j, a += BLEND_TILE_ROWS) {
+        for (size_t k = 0; k < BLEND_TILE_ROWS; ++k) acc[k] += a[k] * params[j];
+    }
+    std::copy(acc, acc + BLEND_TILE_ROWS, out);
+#endif
+}
+
+}  // namespace internal
+}  // namespace smplx
+
+#endif  // ifndef SMPLX_INTERNAL_BLEND_TILES_6A1F3D85_2B9C_4E07_93D4_C8E51F06A27B
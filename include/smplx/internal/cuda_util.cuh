@@ -110,9 +110,9 @@ __host__ void from_host_eigen_matrix(Scalar*& d_data, const EigenType& src) {
     cudaMalloc((void**)&d_data, dsize);
     cudaMemcpy(d_data, src.data(), dsize, cudaMemcpyHostToDevice);
 }
-template <int Option>
+template <class SparseType>
 __host__ void from_host_eigen_sparse_matrix(internal::GPUSparseMatrix& d_data,
-                            const Eigen::SparseMatrix<float, Option>& src) {
+                            const SparseType& src) {
     const size_t nnz = src.nonZeros();
     d_data.nnz = (int) nnz;
     d_data.cols = (int) src.cols();
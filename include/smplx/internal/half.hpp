@@ -0,0 +1,141 @@
+#pragma once
+#ifndef SMPLX_INTERNAL_HALF_2D7E5B90_4C1F_4E3A_8B6D_91F0A3C7E258
+#define SMPLX_INTERNAL_HALF_2D7E5B90_4C1F_4E3A_8B6D_91F0A3C7E258
+
+// Reduced precision (fp16/bf16) storage: conversion and matrix products with
+// fp32 accumulation
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "smplx/defs.hpp"
+
+#if defined(__F16C__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__ARM_FP16_FORMAT_IEEE)
+#include <arm_neon.h>
+#define SMPLX_NEON_FP16
+#endif
+
+namespace smplx {
+namespace internal {
+
+inline uint32_t float_bits(float f) {
+    uint32_t u;
+    std::memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+inline float bits_float(uint32_t u) {
+    float f;
+    std::memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+// IEEE half to float, branch-free so that loops over it vectorize.
+// Inf/nan are not handled (blend shapes are finite).
+inline float half_to_float(uint16_t h) {
+    const uint32_t u = h;
+    // Normal: rebias exponent; zero or subnormal: mant * 2^-24
+    const float normal = bits_float(((u & 0x7fffu) << 13) + (112u << 23));
+    const float subnormal = static_cast<float>(u & 0x3ffu) * 5.9604645e-8f;
+    const float val = (u & 0x7c00u) ? normal : subnormal;
+    return bits_float(float_bits(val) | ((u & 0x8000u) << 16));
+}
+
+// Float to IEEE half, round to nearest even
+inline uint16_t float_to_half(float f) {
+    const uint32_t u = float_bits(f);
+    const uint16_t sign = static_cast<uint16_t>((u >> 16) & 0x8000u);
+    const uint32_t abs_u = u & 0x7fffffffu;
+    if (abs_u >= 0x7f800000u) {
+        // inf/nan
+        return sign | 0x7c00u | (abs_u > 0x7f800000u ? 0x200u : 0u);
+    }
+    if (abs_u >= 0x477ff000u) return sign | 0x7c00u;  // overflow to inf
+    if (abs_u < 0x38800000u) {
+        // Subnormal half (or zero): round abs(f) / 2^-24 to integer
+        const float scaled = bits_float(abs_u) * 16777216.f;
+        return sign | static_cast<uint16_t>(std::nearbyint(scaled));
+    }
+    // Normal: rebias exponent and round mantissa to 10 bits
+    uint32_t rounded = abs_u + 0xfffu + ((abs_u >> 13) & 1u);
+    return sign | static_cast<uint16_t>((rounded - (112u << 23)) >> 13);
+}
+
+// bfloat16 to float
+inline float bf16_to_float(uint16_t h) {
+    return bits_float(static_cast<uint32_t>(h) << 16);
+}
+
+// Float to bfloat16, round to nearest even
+inline uint16_t float_to_bf16(float f) {
+    const uint32_t u = float_bits(f);
+    if ((u & 0x7fffffffu) > 0x7f800000u) return static_cast<uint16_t>((u >> 16) | 0x40u);  // nan
+    return static_cast<uint16_t>((u + 0x7fffu + ((u >> 16) & 1u)) >> 16);
+}
+
+// Encode n floats in reduced precision (fp16 or bf16)
+inline void from_float(const float* src, uint16_t* dst, size_t n, Precision precision) {
+    if (precision == Precision::bf16) {
+        for (size_t i = 0; i < n; ++i) dst[i] = float_to_bf16(src[i]);
+    } else {
+        for (size_t i = 0; i < n; ++i) dst[i] = float_to_half(src[i]);
+    }
+}
+
+// Decode n reduced precision (fp16 or bf16) values to float
+inline void to_float(const uint16_t* src, float* dst, size_t n, Precision precision) {
+    size_t i = 0;
+    if (precision == Precision::bf16) {
+        // Plain shifts, vectorized by the compiler
+        for (; i < n; ++i) dst[i] = bits_float(static_cast<uint32_t>(src[i]) << 16);
+        return;
+    }
+#if defined(__F16C__)
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i))));
+    }
+#elif defined(SMPLX_NEON_FP16)
+    for (; i + 4 <= n; i += 4) {
+        vst1q_f32(dst + i, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(src + i))));
+    }
+#endif
+    for (; i < n; ++i) dst[i] = half_to_float(src[i]);
+}
+
+// out += a.block(row_begin, col_begin, out.rows(), params.rows()) * params
+// where a is a column-major matrix with leading dimension lda stored in
+// reduced precision. Tiles of a are converted to fp32 into a small buffer that
+// stays in cache and multiplied from there, all arithmetic is in fp32.
+// params: (#cols, #bodies)
+// out: (#rows, #bodies)
+inline void reduced_gemm_add(const uint16_t* a, size_t lda, Precision precision,
+        size_t row_begin, size_t col_begin,
+        const Eigen::Ref<const MatrixColMajor>& params,
+        Eigen::Ref<MatrixColMajor> out) {
+    constexpr size_t TILE_ROWS = 256, TILE_COLS = 16;
+    Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic, 0, TILE_ROWS, TILE_COLS> tile;
+    const size_t n_rows = out.rows(), n_cols = params.rows();
+    for (size_t i = 0; i < n_rows; i += TILE_ROWS) {
+        const size_t tile_rows = std::min(TILE_ROWS, n_rows - i);
+        auto out_block = out.middleRows(i, tile_rows);
+        for (size_t j = 0; j < n_cols; j += TILE_COLS) {
+            const size_t tile_cols = std::min(TILE_COLS, n_cols - j);
+            tile.resize(tile_rows, tile_cols);
+            for (size_t k = 0; k < tile_cols; ++k) {
+                to_float(a + (col_begin + j + k) * lda + row_begin + i,
+                        tile.col(k).data(), tile_rows, precision);
+            }
+            out_block.noalias() += tile * params.middleRows(j, tile_cols);
+        }
+    }
+}
+
+}  // namespace internal
+}  // namespace smplx
+
+#endif  // ifndef SMPLX_INTERNAL_HALF_2D7E5B90_4C1F_4E3A_8B6D_91F0A3C7E258
@@ -0,0 +1,188 @@
+#pragma once
+#ifndef SMPLX_INTERNAL_KINEMATICS_6A0D2C1E_7F43_4B8A_9E15_3C5B8D20F7A4
+#define SMPLX_INTERNAL_KINEMATICS_6A0D2C1E_7F43_4B8A_9E15_3C5B8D20F7A4
+
+// Vectorized forward kinematics.
+// Joint data is processed in structure-of-arrays (SoA) form, (#joints, 12) arrays
+// where column k holds entry k of the row-major 3x4 transform of every joint, so
+// that Eigen can evaluate each step for many joints at once in SIMD lanes
+// (the widest instruction set enabled at compile time, e.g. SSE/AVX/AVX-512/NEON).
+
+#include "smplx/smplx.hpp"
+
+namespace smplx {
+namespace internal {
+
+// Homogeneous transforms at each joint (bottom row omitted), (#joints, 12)
+using JointTransforms = Eigen::Matrix<Scalar, Eigen::Dynamic, 12, Eigen::RowMajor>;
+using AffineTransformMap = Eigen::Map<Eigen::Matrix<Scalar, 3, 4, Eigen::RowMajor> >;
+using RotationMap = Eigen::Map<Eigen::Matrix<Scalar, 3, 3, Eigen::RowMajor> >;
+
+// One value per joint
+template<class ModelConfig>
+using JointArray = Eigen::Array<Scalar, ModelConfig::n_joints(), 1>;
+// SoA joint transforms, (#joints, 12)
+template<class ModelConfig>
+using JointTransformsSoA = Eigen::Array<Scalar, ModelConfig::n_joints(), 12>;
+
+// Angle-axis to rotation matrix for all joints at once, branch-free.
+// Rotations with angle below 1e-5 map exactly to identity, as in util::rodrigues.
+// x, y, z: angle-axis components for each joint
+// -> out: SoA transforms, only the rotation part (cols 0-2, 4-6, 8-10) is written
+template<class ModelConfig>
+inline void rodrigues(const JointArray<ModelConfig>& x,
+        const JointArray<ModelConfig>& y,
+        const JointArray<ModelConfig>& z,
+        JointTransformsSoA<ModelConfig>& out) {
+    using Arr = JointArray<ModelConfig>;
+    const Arr theta = (x.square() + y.square() + z.square()).sqrt();
+    const auto small = theta < 1e-5f;
+    const Arr inv_theta = small.select(0.f, small.select(1.f, theta).inverse());
+    const Arr c = small.select(1.f, theta.cos());
+    const Arr s = theta.sin();
+    const Arr t = 1.f - c;
+    const Arr rx = x * inv_theta, ry = y * inv_theta, rz = z * inv_theta;
+    const Arr txy = t * rx * ry, txz = t * rx * rz, tyz = t * ry * rz;
+
+    out.col(0) = c + t * rx.square();
+    out.col(1) = txy - s * rz;
+    out.col(2) = txz + s * ry;
+    out.col(4) = txy + s * rz;
+    out.col(5) = c + t * ry.square();
+    out.col(6) = tyz - s * rx;
+    out.col(8) = txz - s * ry;
+    out.col(9) = tyz + s * rx;
+    out.col(10) = c + t * rz.square();
+}
+
+// Convert a parameter vector (laid out as Body::params) to local joint rotations
+// and pose blend shape params.
+// out_joint_transforms: (#joints, 12); only the rotation part is written
+// out_pose_blend_params: (#pose blends), flattened (R - I) row-major for each
+//                        non-root joint
+template<class ModelConfig>
+inline void params_to_local_transforms(const Model<ModelConfig>& model,
+        const Eigen::Ref<const Vector>& params,
+        Eigen::Ref<JointTransforms> out_joint_transforms,
+        Scalar* out_pose_blend_params) {
+    constexpr size_t n_joints = ModelConfig::n_joints();
+    constexpr size_t n_explicit = ModelConfig::n_explicit_joints();
+    constexpr size_t n_hand_joints = ModelConfig::n_hand_pca_joints();
+    constexpr size_t n_hand_pca = ModelConfig::n_hand_pca();
+    // Will store full pose params (angle-axis), including hand
+    Eigen::Matrix<Scalar, 3 * n_joints, 1> full_pose;
+
+    // Copy body pose onto full pose
+    full_pose.template head<3 * n_explicit>().noalias() =
+        params.template segment<3 * n_explicit>(3);
+    if (n_hand_joints > 0) {
+        // Use hand PCA weights to fill in hand pose within full pose
+        // (accumulated in place, as mean + comps * pca would allocate a temporary)
+        auto hand_pose_l = full_pose.template segment<3 * n_hand_joints>(3 * n_explicit);
+        auto hand_pose_r = full_pose.template tail<3 * n_hand_joints>();
+        hand_pose_l = model.hand_mean_l;
+        hand_pose_l.noalias() += model.hand_comps_l *
+            params.template segment<n_hand_pca>(3 + 3 * n_explicit);
+        hand_pose_r = model.hand_mean_r;
+        hand_pose_r.noalias() += model.hand_comps_r *
+            params.template segment<n_hand_pca>(3 + 3 * n_explicit + n_hand_pca);
+    }
+
+    // Convert angle-axis to rotation matrix using rodrigues, all joints at once
+    using StridedMap = Eigen::Map<const JointArray<ModelConfig>, 0, Eigen::InnerStride<3> >;
+    JointTransformsSoA<ModelConfig> rot;
+    rodrigues<ModelConfig>(StridedMap(full_pose.data()),
+            StridedMap(full_pose.data() + 1), StridedMap(full_pose.data() + 2), rot);
+
+    // Store rotations and (R - I) of non-root joints
+    Eigen::Map<Eigen::Matrix<Scalar, n_joints - 1, 9, Eigen::RowMajor> >
+        pose_blend_params(out_pose_blend_params);
+    for (int r = 0; r < 3; ++r) {
+        for (int c = 0; c < 3; ++c) {
+            out_joint_transforms.col(4 * r + c) = rot.col(4 * r + c).matrix();
+            pose_blend_params.col(3 * r + c) =
+                rot.col(4 * r + c).template tail<n_joints - 1>().matrix();
+        }
+        pose_blend_params.col(4 * r).array() -= 1.f;
+    }
+}
+
+// Transform local to global coordinates, one level of the kinematic tree at a time
+// Inputs: trans, joints_shaped (#joints, 3)
+// Outputs: joints (#joints, 3)
+// Input/output: joint_transforms (#joints, 12); rotation part must be filled
+//               (see params_to_local_transforms)
+template<class ModelConfig>
+inline void local_to_global(const Eigen::Ref<const Vector3f>& trans,
+        const Eigen::Ref<const Points>& joints_shaped,
+        Eigen::Ref<JointTransforms> joint_transforms,
+        Eigen::Ref<Points> joints) {
+    constexpr size_t n_joints = ModelConfig::n_joints();
+    using LevelTransforms = Eigen::Array<Scalar, Eigen::Dynamic, 12,
+          Eigen::ColMajor, n_joints, 12>;
+    static constexpr auto sched = ModelConfig::kinematic_schedule();
+    static_assert(sched.parents_ordered,
+            "ModelConfig::parent must satisfy parent[i] < i");
+
+    // Gather local transforms and shaped joints in depth order
+    JointTransformsSoA<ModelConfig> transforms;
+    Eigen::Array<Scalar, n_joints, 3> joints_sorted;
+    for (size_t k = 0; k < n_joints; ++k) {
+        const size_t i = sched.level_order[k];
+        transforms.row(k) = joint_transforms.row(i).array();
+        joints_sorted.row(k) = joints_shaped.row(i).array();
+    }
+
+    // Set relative translation
+    for (int r = 0; r < 3; ++r) {
+        transforms(0, 4 * r + 3) = joints_sorted(0, r) + trans(r);
+        for (size_t k = 1; k < n_joints; ++k) {
+            transforms(k, 4 * r + 3) =
+                joints_sorted(k, r) - joints_sorted(sched.level_parent_pos[k], r);
+        }
+    }
+
+    // Compose with parent, for all joints at the same depth at once
+    LevelTransforms parent_transforms, composed;
+    for (size_t d = 1; d < sched.n_levels; ++d) {
+        const size_t begin = sched.level_begin[d];
+        const size_t n = sched.level_begin[d + 1] - begin;
+        parent_transforms.resize(n, 12);
+        composed.resize(n, 12);
+        for (size_t k = 0; k < n; ++k) {
+            parent_transforms.row(k) = transforms.row(sched.level_parent_pos[begin + k]);
+        }
+        auto local = transforms.middleRows(begin, n);
+        for (int r = 0; r < 3; ++r) {
+            for (int c = 0; c < 4; ++c) {
+                composed.col(4 * r + c) =
+                    parent_transforms.col(4 * r) * local.col(c) +
+                    parent_transforms.col(4 * r + 1) * local.col(4 + c) +
+                    parent_transforms.col(4 * r + 2) * local.col(8 + c);
+            }
+            composed.col(4 * r + 3) += parent_transforms.col(4 * r + 3);
+        }
+        local = composed;
+    }
+
+    // Grab the joint positions in case the user wants them, then
+    // normalize the translation to global
+    for (size_t k = 0; k < n_joints; ++k) {
+        joints.row(sched.level_order[k]) << transforms(k, 3), transforms(k, 7), transforms(k, 11);
+    }
+    for (int r = 0; r < 3; ++r) {
+        transforms.col(4 * r + 3) -= transforms.col(4 * r) * joints_sorted.col(0) +
+            transforms.col(4 * r + 1) * joints_sorted.col(1) +
+            transforms.col(4 * r + 2) * joints_sorted.col(2);
+    }
+
+    // Scatter back to joint order
+    for (size_t k = 0; k < n_joints; ++k) {
+        joint_transforms.row(sched.level_order[k]) = transforms.row(k).matrix();
+    }
+}
+
+}  // namespace internal
+}  // namespace smplx
+
+#endif  // ifndef SMPLX_INTERNAL_KINEMATICS_6A0D2C1E_7F43_4B8A_9E15_3C5B8D20F7A4
@@ -0,0 +1,248 @@
+#pragma once
+#ifndef SMPLX_INTERNAL_LBS_991DD512_3285_495F_A9B6_55CB8E39160F
+#define SMPLX_INTERNAL_LBS_991DD512_3285_495F_A9B6_55CB8E39160F
+
+// CPU building blocks of the SMPL forward pass, shared by Body and BodyBatch
+
+#include "smplx/smplx.hpp"
+#include "smplx/util.hpp"
+#include "smplx/internal/blend_tiles.hpp"
+#include "smplx/internal/half.hpp"
+#include "smplx/internal/kinematics.hpp"
+#include "smplx/internal/thread_pool.hpp"
+
+namespace smplx {
+namespace internal {
+
+// Minimum work (multiply-adds) of one chunk of a parallel loop, so that
+// scheduling overhead stays small
+constexpr size_t CHUNK_MIN_WORK = 4096;
+
+// Minimum number of vertices handled by one thread, for a loop doing
+// work_per_vert multiply-adds per vertex. Derived from the work so that
+// heavy loops (pose blend shapes, ~1500 multiply-adds per SMPL-X vertex)
+// are split finely enough to keep many threads busy
+inline size_t verts_grain(size_t work_per_vert) {
+    return std::max<size_t>(CHUNK_MIN_WORK / std::max<size_t>(work_per_vert, 1), 1);
+}
+
+// Multiply-adds per vertex of LBS (blending the transforms of the joints
+// influencing it and applying the result)
+template<class ModelConfig>
+inline size_t lbs_work_per_vert(const Model<ModelConfig>& model) {
+    return 12 * (model.n_vert_influences() + 1);
+}
+
+// Apply shape blend shapes to one or more bodies, multithreaded over vertices
+// shape_params: (#shape blends, #bodies)
+// -> out_verts_shaped: (3*#verts, #bodies) model.verts + shape blend shapes,
+//                      each col is a point cloud (#verts, 3) in row-major order
+template<class ModelConfig>
+inline void shape_blend_shapes(const Model<ModelConfig>& model,
+        const Eigen::Ref<const MatrixColMajor>& shape_params,
+        Eigen::Ref<MatrixColMajor> out_verts_shaped) {
+    constexpr size_t n_shape_blends = ModelConfig::n_shape_blends();
+    Eigen::Map<const Vector> verts_init_flat(model.verts.data(), model.n_verts() * 3);
+    parallel_for(0, ModelConfig::n_verts(),
+            verts_grain(3 * n_shape_blends * shape_params.cols()),
+        [&](size_t begin, size_t end) {
+            const size_t n_rows = 3 * (end - begin);
+            auto verts_shaped = out_verts_shaped.middleRows(3 * begin, n_rows);
+            if (model.blend_shapes_precision() != Precision::fp32) {
+                verts_shaped.setZero();
+                reduced_gemm_add(model.blend_shapes_half.data(), 3 * model.n_verts(),
+                        model.blend_shapes_precision(), 3 * begin, 0,
+                        shape_params, verts_shaped);
+            } else {
+                verts_shaped.noalias() =
+                    model.blend_shapes.block(3 * begin, 0, n_rows, n_shape_blends) *
+                    shape_params;
+            }
+            verts_shaped.colwise() += verts_init_flat.segment(3 * begin, n_rows);
+        });
+}
+
+// Add pose blend shapes to one or more bodies, multithreaded over vertices
+// pose_blend_params: (#pose blends, #bodies), see params_to_local_transforms
+// verts_shaped: (3*#verts, #bodies) vertices from shape_blend_shapes
+// -> out_verts_shaped: (3*#verts, #bodies) verts_shaped + pose blend shapes;
+//                      may be the same as verts_shaped
+// pose_latent: scratch space for low-rank pose blend shapes; does not allocate
+//              if it already has the right size from a previous call
+template<class ModelConfig>
+inline void pose_blend_shapes(const Model<ModelConfig>& model,
+        const Eigen::Ref<const MatrixColMajor>& pose_blend_params,
+        const Eigen::Ref<const MatrixColMajor>& verts_shaped,
+        Eigen::Ref<MatrixColMajor> out_verts_shaped,
+        MatrixColMajor& pose_latent) {
+    constexpr size_t n_shape_blends = ModelConfig::n_shape_blends();
+    constexpr size_t n_pose_blends = ModelConfig::n_pose_blends();
+    const bool low_rank = model.pose_blend_rank() > 0;
+
+    // Low-rank pose blend shapes: project pose params onto the basis first
+    if (low_rank) {
+        pose_latent.noalias() = model.pose_blend_coeffs * pose_blend_params;
+    }
+
+    const size_t n_basis = low_rank ? model.pose_blend_rank() : n_pose_blends;
+    parallel_for(0, ModelConfig::n_verts(),
+            verts_grain(3 * n_basis * pose_blend_params.cols()),
+        [&](size_t begin, size_t end) {
+            const size_t n_rows = 3 * (end - begin);
+            auto out = out_verts_shaped.middleRows(3 * begin, n_rows);
+            out = verts_shaped.middleRows(3 * begin, n_rows);
+            if (low_rank) {
+                out.noalias() +=
+                    model.pose_blend_basis.middleRows(3 * begin, n_rows) * pose_latent;
+            } else if (model.blend_shapes_precision() != Precision::fp32) {
+                reduced_gemm_add(model.blend_shapes_half.data(), 3 * model.n_verts(),
+                        model.blend_shapes_precision(), 3 * begin, n_shape_blends,
+                        pose_blend_params, out);
+            } else {
+                out.noalias() += model.blend_shapes.block(3 * begin, n_shape_blends,
+                        n_rows, n_pose_blends) * pose_blend_params;
+            }
+        });
+}
+
+// Area-weighted vertex normals of a triangle mesh
+// verts: (#verts, 3); faces: (#faces, 3)
+// -> out: (#verts, 3) unit normals (zero for vertices not in any face)
+inline void vertex_normals(const Eigen::Ref<const Points>& verts,
+        const Eigen::Ref<const Triangles>& faces, Eigen::Ref<Points> out) {
+    out.setZero();
+    for (Eigen::Index i = 0; i < faces.rows(); ++i) {
+        const Eigen::Matrix<Scalar, 1, 3> face_normal =
+            (verts.row(faces(i, 1)) - verts.row(faces(i, 0))).cross(
+             verts.row(faces(i, 2)) - verts.row(faces(i, 0)));
+        for (int j = 0; j < 3; ++j) out.row(faces(i, j)) += face_normal;
+    }
+    for (Eigen::Index i = 0; i < out.rows(); ++i) {
+        const Scalar norm = out.row(i).norm();
+        if (norm > 0.f) out.row(i) /= norm;
+    }
+}
+
+// Blend the transforms of the joints influencing vertex i (CSR weights)
+// -> out: 3x4 row-major transform
+template<class ModelConfig>
+inline void blend_vert_transform(const Model<ModelConfig>& model,
+        const Eigen::Ref<const JointTransforms>& joint_transforms, size_t i,
+        Eigen::Matrix<Scalar, 1, 12>& out) {
+    const auto* outer = model.weights_rowmajor.outerIndexPtr();
+    const auto* inner = model.weights_rowmajor.innerIndexPtr();
+    const Scalar* values = model.weights_rowmajor.valuePtr();
+    out.setZero();
+    for (auto k = outer[i]; k < outer[i + 1]; ++k) {
+        out.noalias() += values[k] * joint_transforms.row(inner[k]);
+    }
+}
+
+// Linear blend skinning of vertices [begin, end), see lbs
+template<class ModelConfig>
+inline void lbs_range(const Model<ModelConfig>& model,
+        const Eigen::Ref<const JointTransforms>& joint_transforms,
+        const Eigen::Ref<const Points>& verts_shaped,
+        Eigen::Ref<Points> out_verts, size_t begin, size_t end,
+        const char* vert_mask = nullptr) {
+    Eigen::Matrix<Scalar, 1, 12> vert_transform;
+    for (size_t i = begin; i < end; ++i) {
+        if (vert_mask && !vert_mask[i]) continue;
+        blend_vert_transform(model, joint_transforms, i, vert_transform);
+        // Apply affine transform to vertex and store to output
+        AffineTransformMap transform(vert_transform.data());
+        out_verts.row(i).noalias() =
+            verts_shaped.row(i).homogeneous() * transform.transpose();
+    }
+}
+
+// Linear blend skinning of vertices and normals [begin, end), see lbs_range;
+// normals are transformed by the cofactor matrix (the inverse transpose up to
+// scale) of each vertex's blended 3x3 transform, then normalized
+// normals: (#verts, 3) unit normals of verts_shaped
+// -> out_verts, out_normals: (#verts, 3) deformed vertices and normals
+template<class ModelConfig>
+inline void lbs_normals_range(const Model<ModelConfig>& model,
+        const Eigen::Ref<const JointTransforms>& joint_transforms,
+        const Eigen::Ref<const Points>& verts_shaped,
+        const Eigen::Ref<const Points>& normals,
+        Eigen::Ref<Points> out_verts, Eigen::Ref<Points> out_normals,
+        size_t begin, size_t end) {
+    Eigen::Matrix<Scalar, 1, 12> vert_transform;
+    for (size_t i = begin; i < end; ++i) {
+        blend_vert_transform(model, joint_transforms, i, vert_transform);
+        AffineTransformMap transform(vert_transform.data());
+        out_verts.row(i).noalias() =
+            verts_shaped.row(i).homogeneous() * transform.transpose();
+        const Vector3f a0 = transform.col(0), a1 = transform.col(1),
+                       a2 = transform.col(2);
+        const Vector3f normal = normals(i, 0) * a1.cross(a2) +
+            normals(i, 1) * a2.cross(a0) + normals(i, 2) * a0.cross(a1);
+        out_normals.row(i).noalias() = normal.normalized().transpose();
+    }
+}
+
+// Linear blend skinning
+// Blends the transforms of the (few) joints influencing each vertex directly
+// from the CSR weights and applies the result, without storing per-vertex
+// transforms.
+// joint_transforms: (#joints, 12) global transforms from local_to_global
+// verts_shaped: (#verts, 3) vertices after blend shapes are applied
+// vert_mask: if not null, only vertices i with vert_mask[i] != 0 are processed
+// -> out_verts: (#verts, 3) deformed vertices
+template<class ModelConfig>
+inline void lbs(const Model<ModelConfig>& model,
+        const Eigen::Ref<const JointTransforms>& joint_transforms,
+        const Eigen::Ref<const Points>& verts_shaped,
+        Eigen::Ref<Points> out_verts,
+        const char* vert_mask = nullptr) {
+    parallel_for(0, ModelConfig::n_verts(), verts_grain(lbs_work_per_vert(model)),
+        [&](size_t begin, size_t end) {
+            lbs_range<ModelConfig>(model, joint_transforms, verts_shaped, out_verts,
+                    begin, end, vert_mask);
+        });
+}
+
+// Pose blend shapes and LBS for one body, fused per tile of vertices using
+// the tiled blend shapes (requires model.blend_shapes_tiled): each tile is
+// posed by blend_tile_gemv and skinned while still in cache
+// pose_blend_params: #pose blends params, see params_to_local_transforms
+// verts_shape_only: (#verts, 3) vertices with shape blend shapes applied
+// skin_range: skin_range(begin, end) skins vertices [begin, end) of
+//             out_verts_shaped, e.g. by lbs_range
+// -> out_verts_shaped: (#verts, 3) verts_shape_only + pose blend shapes
+template<class ModelConfig, class SkinRange>
+inline void pose_blend_shapes_lbs_tiled(const Model<ModelConfig>& model,
+        const Scalar* pose_blend_params,
+        const Eigen::Ref<const Points>& verts_shape_only,
+        Eigen::Ref<Points> out_verts_shaped,
+        SkinRange skin_range) {
+    constexpr size_t n_verts = ModelConfig::n_verts();
+    constexpr size_t n_blend_shapes = ModelConfig::n_blend_shapes();
+    const size_t grain = verts_grain(3 * ModelConfig::n_pose_blends() +
+            lbs_work_per_vert(model));
+    parallel_for(0, n_blend_tiles(n_verts),
+            (grain + BLEND_TILE_VERTS - 1) / BLEND_TILE_VERTS,
+        [&](size_t tile_begin, size_t tile_end) {
+            Scalar base[BLEND_TILE_ROWS], posed[BLEND_TILE_ROWS];
+            for (size_t t = tile_begin; t < tile_end; ++t) {
+                const size_t begin = t * BLEND_TILE_VERTS;
+                const size_t end = std::min(begin + BLEND_TILE_VERTS, n_verts);
+                const size_t n_rows = 3 * (end - begin);
+                std::copy(verts_shape_only.data() + 3 * begin,
+                        verts_shape_only.data() + 3 * end, base);
+                std::fill(base + n_rows, base + BLEND_TILE_ROWS, Scalar(0));
+                blend_tile_gemv(model.blend_shapes_tiled.data() +
+                        t * n_blend_shapes * BLEND_TILE_ROWS,
+                        ModelConfig::n_shape_blends(), ModelConfig::n_pose_blends(),
+                        pose_blend_params, base, posed);
+                std::copy(posed, posed + n_rows, out_verts_shaped.data() + 3 * begin);
+                skin_range(begin, end);
+            }
+        });
+}
+
+}  // namespace internal
+}  // namespace smplx
+
+#endif  // ifndef SMPLX_INTERNAL_LBS_991DD512_3285_495F_A9B6_55CB8E39160F
@@ -0,0 +1,173 @@
+#pragma once
+#ifndef SMPLX_INTERNAL_MODEL_FILE_5C3A9E47_18D2_4B6F_A0E3_7D41F96B2C85
+#define SMPLX_INTERNAL_MODEL_FILE_5C3A9E47_18D2_4B6F_A0E3_7D41F96B2C85
+
+// Native binary model format (.smplxbin), designed to be memory-mapped
+// and used in place.
+// Layout (little-endian):
+//   ModelFileHeader
+//   ModelFileArray[n_arrays]
+//   array data, each starting at a multiple of MODEL_FILE_ALIGN
+// Each array is stored in the memory layout of the corresponding Model
+// member (e.g. blend_shapes column-major, sparse matrices as the
+// values/inner/outer arrays of their compressed form).
+// Each array records the CRC-32 of its data. Arrays derived from others
+// (e.g. joints from v_template and J_regressor) also record a CRC over the
+// CRCs of their source arrays, so that stale or corrupt derived data is
+// detected on load without recomputing it.
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace smplx {
+namespace internal {
+
+constexpr char MODEL_FILE_MAGIC[8] = {'S', 'M', 'P', 'L', 'X', 'B', 'I', 'N'};
+constexpr uint32_t MODEL_FILE_VERSION = 3;
+constexpr size_t MODEL_FILE_ALIGN = 64;
+
+// Element type of an array
+enum class DType : uint32_t {
+    f32 = 0, i32 = 1, u32 = 2, f16 = 3, bf16 = 4
+};
+
+struct ModelFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t n_arrays;
+    uint64_t file_size;
+    // Model name (ModelConfig::model_name) of the writer, informational
+    char model_name[32];
+};
+
+struct ModelFileArray {
+    char name[48];
+    uint32_t dtype;
+    uint32_t ndim;
+    uint64_t shape[2];
+    // Offset from start of file
+    uint64_t offset;
+    uint64_t nbytes;
+    // CRC-32 of the data
+    uint32_t crc32;
+    // For derived arrays, CRC-32 of the crc32 fields of the source arrays
+    // in order; 0 otherwise
+    uint32_t source_crc32;
+};
+
+// Size in bytes of an element of given type
+size_t dtype_size(DType dtype);
+
+// Read-only view of a model file in memory (memory-mapped file or other
+// shared memory); does not own the memory
+class ModelFileView {
+public:
+    // Validate and index the file contents at data;
+    // exits with an error message if invalid
+    // source: file name, for error messages
+    ModelFileView(const void* data, size_t size, const std::string& source);
+
+    // Returns the array with given name, or nullptr if not present
+    const ModelFileArray* find(const std::string& name) const;
+
+    // Returns a pointer to the data of an array;
+    // exits with an error message if not present or type/shape does not match
+    // shape: expected shape; ANY_DIM matches any size
+    const void* get(const std::string& name, DType dtype,
+            std::initializer_list<size_t> shape) const;
+    template<class T>
+    const T* get(const std::string& name, DType dtype,
+            std::initializer_list<size_t> shape) const {
+        return static_cast<const T*>(get(name, dtype, shape));
+    }
+
+    // Check that the data of an array matches its recorded CRC, and if
+    // sources is not empty, that it was derived from the given source arrays
+    // (in order) as currently stored, also checking their data;
+    // exits with an error message if not
+    void verify(const std::string& name,
+            std::initializer_list<const char*> sources = {}) const;
+
+    // Check the data of all arrays; exits with an error message on mismatch
+    void verify_all() const;
+
+    const ModelFileHeader& header() const { return *_header; }
+    // Array table, header().n_arrays entries
+    const ModelFileArray* arrays() const { return _arrays; }
+
+    static constexpr size_t ANY_DIM = (size_t)-1;
+
+private:
+    const char* _data;
+    const ModelFileHeader* _header;
+    const ModelFileArray* _arrays;
+    std::string _source;
+};
+
+// Builds a model file from arrays owned by the caller
+class ModelFileWriter {
+public:
+    // Add an array; data must stay valid until write()
+    // sources: names of arrays (added before or after) the array is
+    //          derived from, see ModelFileView::verify
+    void add(const std::string& name, DType dtype,
+            std::initializer_list<size_t> shape, const void* data,
+            std::initializer_list<const char*> sources = {});
+
+    // Total size of the file in bytes
+    size_t file_size() const;
+
+    // Write the file contents to out, which must hold file_size() bytes
+    // write_magic: if false, the magic is left zeroed, to be stored last
+    //              with store_magic_release
+    void write(char* out, const char* model_name, bool write_magic = true) const;
+
+    // Write to file at path, replacing it by renaming a temporary file
+    // (path + ".tmp") over it, so that existing mappings of path stay valid;
+    // exits with an error message on failure
+    void write(const std::string& path, const char* model_name) const;
+
+private:
+    std::vector<ModelFileArray> _arrays;
+    std::vector<const void*> _data;
+    std::vector<std::vector<std::string>> _sources;
+};
+
+// Modification time of file, or -1 if it does not exist
+double file_mtime(const std::string& path);
+
+// Memory-map a file read-only; the mapping is released when the last copy
+// of the returned pointer is destroyed. Exits with an error message on failure.
+// -> size: file size in bytes
+std::shared_ptr<const void> map_file(const std::string& path, size_t& size);
+
+// Create (or replace) a named POSIX shared memory segment of given size and
+// map it read-write; the mapping is released with the returned pointer, the
+// segment persists until unlink_shared_memory. Exits with an error message
+// on failure or if not supported (Windows).
+std::shared_ptr<void> create_shared_memory(const std::string& name, size_t size);
+
+// Map an existing named shared memory segment read-only.
+// -> size: segment size in bytes
+std::shared_ptr<const void> map_shared_memory(const std::string& name, size_t& size);
+
+// Remove a named shared memory segment
+void unlink_shared_memory(const std::string& name);
+
+// Store the magic of a model file written with write_magic = false, with
+// release semantics, so that a process observing it with
+// load_magic_acquire also observes the complete contents
+void store_magic_release(void* data);
+
+// Check the magic of a model file of given size with acquire semantics,
+// returns false if it is not (yet) stored
+bool load_magic_acquire(const void* data, size_t size);
+
+}  // namespace internal
+}  // namespace smplx
+
+#endif  // ifndef SMPLX_INTERNAL_MODEL_FILE_5C3A9E47_18D2_4B6F_A0E3_7D41F96B2C85
@@ -0,0 +1,153 @@
+#pragma once
+#ifndef SMPLX_INTERNAL_NPZ_READER_2E7B5D90_4C1A_4F83_9B6E_A51D0C37F2E8
+#define SMPLX_INTERNAL_NPZ_READER_2E7B5D90_4C1A_4F83_9B6E_A51D0C37F2E8
+
+// Reader for numpy .npz files (zip archives of .npy arrays), used by
+// Model and Sequence instead of cnpy::npz_load.
+// The zip central directory is indexed once on open; arrays are then read
+// on demand, each inflated as a stream directly into its destination buffer
+// (converting the element type on the fly), with the requested arrays
+// read in parallel on the thread pool. Row ranges of an array can be read
+// without reading the rest: stored entries are read in place, deflated
+// ones are inflated from the nearest access point recorded by earlier reads.
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "smplx/defs.hpp"
+
+namespace smplx {
+namespace internal {
+
+class NpzReader {
+public:
+    // Element type of an array in the file
+    enum class DType { f32, f64, i32, i64, u32, u64, u8, bytes, unicode };
+
+    // Header of a .npy array
+    struct ArrayInfo {
+        DType dtype;
+        // Size of one element in bytes
+        size_t word_size;
+        bool fortran_order;
+        std::vector<size_t> shape;
+        size_t numel() const;
+    };
+
+    // Index the archive at path; exits with an error message if it cannot
+    // be read or is not a valid zip archive
+    explicit NpzReader(const std::string& path);
+    ~NpzReader();
+
+    // Whether the archive contains array key
+    bool has(const std::string& key) const;
+
+    // Header of array key, read (by inflating only its first bytes) on first
+    // access; exits with an error message if not present
+    const ArrayInfo& info(const std::string& key);
+    const std::vector<size_t>& shape(const std::string& key) { return info(key).shape; }
+
+    // Queue reading array key into the matrix/block dst, which must have the
+    // final size and direct access (e.g. Matrix, Block of a Matrix).
+    // The array is viewed as a matrix of (product of all but last dims, last dim)
+    // (1-D arrays as column vectors), and must match dst's size.
+    // shape: expected shape; ANY_DIM matches any size
+    // dst and the reader must stay valid until read().
+    template<class Derived>
+    void add(const std::string& key, std::initializer_list<size_t> shape,
+            Derived&& dst) {
+        _add(key, shape, dst.data(), type_of(dst.data()), size_t(dst.rows()),
+                size_t(dst.cols()), size_t(dst.rowStride()), size_t(dst.colStride()),
+                0, false);
+    }
+
+    // Queue reading rows [row_begin, row_begin + dst.rows()) of the matrix
+    // view of array key into dst; see add
+    template<class Derived>
+    void add_rows(const std::string& key, std::initializer_list<size_t> shape,
+            size_t row_begin, Derived&& dst) {
+        _add(key, shape, dst.data(), type_of(dst.data()), size_t(dst.rows()),
+                size_t(dst.cols()), size_t(dst.rowStride()), size_t(dst.colStride()),
+                row_begin, true);
+    }
+
+    // Read all queued arrays, in parallel on the thread pool; exits with an
+    // error message on failure
+    void read();
+
+    // Read a scalar array (e.g. mocap_framerate) immediately
+    double read_scalar(const std::string& key);
+
+    // Read a string array (e.g. gender) immediately; numpy unicode strings
+    // are narrowed to their low byte per character
+    std::string read_string(const std::string& key);
+
+    static constexpr size_t ANY_DIM = (size_t)-1;
+
+    // Access points into a deflated entry, see npz_reader.cpp
+    struct SeekIndex;
+
+private:
+    // Destination element types
+    enum class Target { f32, f64, u32 };
+    static Target type_of(const float*) { return Target::f32; }
+    static Target type_of(const double*) { return Target::f64; }
+    static Target type_of(const uint32_t*) { return Target::u32; }
+
+    // Zip entry
+    struct Entry {
+        // Offset of local file header
+        uint64_t header_offset;
+        uint64_t compressed_size;
+        uint64_t size;
+        // 0: stored, 8: deflate
+        uint16_t method;
+        bool has_info = false;
+        ArrayInfo info;
+        // Offset of array data in the uncompressed .npy
+        size_t data_offset;
+        // Created by the first row range read of a deflated entry
+        std::unique_ptr<SeekIndex> index;
+    };
+
+    // Queued read
+    struct Request {
+        Entry* entry;
+        void* dst;
+        Target target;
+        size_t rows, cols, row_stride, col_stride;
+        // First row to read
+        size_t row_begin;
+    };
+
+    void _add(const std::string& key, std::initializer_list<size_t> shape,
+            void* dst, Target target, size_t rows, size_t cols,
+            size_t row_stride, size_t col_stride, size_t row_begin, bool partial);
+    Entry& _entry(const std::string& key);
+    // Start of entry data in the archive; exits with an error message if invalid
+    const unsigned char* _entry_data(const Entry& entry) const;
+    // As above, but returns nullptr and sets err if invalid
+    const unsigned char* _entry_data(const Entry& entry, std::string& err) const;
+    // Read req; returns an error message, empty on success.
+    // Never exits, so that it may run on pool workers
+    std::string _read(const Request& req) const;
+    [[noreturn]] void _error(const std::string& msg) const;
+
+    std::string _path;
+    // Memory-mapped archive
+    std::shared_ptr<const void> _mapped;
+    const unsigned char* _data;
+    size_t _file_size;
+    std::unordered_map<std::string, Entry> _entries;
+    std::vector<Request> _requests;
+};
+
+}  // namespace internal
+}  // namespace smplx
+
+#endif  // ifndef SMPLX_INTERNAL_NPZ_READER_2E7B5D90_4C1A_4F83_9B6E_A51D0C37F2E8
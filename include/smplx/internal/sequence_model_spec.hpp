@@ -13,18 +13,22 @@ namespace internal {
     // so we have to implement in a separate struct;
     // Also, C++14 doesn't allow specializing member structs, so we have to put it here
     // (we are mixing C++14 (nvcc) with C++17
+    // BodyT: Body<ModelConfig>, or any type with the same trans(), pose() and
+    // shape() parameter accessors
     template<class SequenceConfig, class ModelConfig>
     struct SequenceModelSpec {
         // Set shape
+        template<class BodyT>
         static void set_shape(const Sequence<SequenceConfig>& seq,
-                Body<ModelConfig>& body) {
+                BodyT& body) {
             throw std::invalid_argument(std::string(
                         "smplx::Sequence does not currently support model: ") +
                     ModelConfig::model_name);
         }
         // Set pose and root transform
+        template<class BodyT>
         static void set_pose(const Sequence<SequenceConfig>& seq,
-                Body<ModelConfig>& body, size_t frame) {
+                BodyT& body, size_t frame) {
             throw std::invalid_argument(std::string(
                         "smplx::Sequence does not currently support model: ") +
                     ModelConfig::model_name);
@@ -34,13 +38,15 @@ namespace internal {
     // ** Per-model specializations **
     template <class SequenceConfig>
     struct SequenceModelSpec<SequenceConfig, model_config::SMPL> {
+        template<class BodyT>
         static void set_shape(const Sequence<SequenceConfig>& seq,
-                Body<model_config::SMPL>& body) {
+                BodyT& body) {
             body.shape().noalias() = seq.shape
                 .template head<model_config::SMPL::n_shape_blends()>();
         }
+        template<class BodyT>
         static void set_pose(const Sequence<SequenceConfig>& seq,
-                Body<model_config::SMPL>& body, size_t frame) {
+                BodyT& body, size_t frame) {
             constexpr size_t n_common = SequenceConfig::n_body_joints() * 3;
             body.trans().noalias() = seq.trans.row(frame).transpose();
             body.pose().template head<n_common>().noalias() =
@@ -51,12 +57,14 @@ namespace internal {
 
     template <class SequenceConfig>
     struct SequenceModelSpec<SequenceConfig, model_config::SMPLH> {
+        template<class BodyT>
         static void set_shape(const Sequence<SequenceConfig>& seq,
-                Body<model_config::SMPLH>& body) {
+                BodyT& body) {
             body.shape().noalias() = seq.shape;
         }
+        template<class BodyT>
         static void set_pose(const Sequence<SequenceConfig>& seq,
-                Body<model_config::SMPLH>& body, size_t frame) {
+                BodyT& body, size_t frame) {
             body.trans().noalias() = seq.trans.row(frame).transpose();
             body.pose().noalias() = seq.pose.row(frame).transpose();
         }
@@ -66,12 +74,14 @@ namespace internal {
     // WARNING: set shape is not supported
     template <class SequenceConfig>
     struct SequenceModelSpec<SequenceConfig, model_config::SMPLX> {
+        template<class BodyT>
         static void set_shape(const Sequence<SequenceConfig>& seq,
-                Body<model_config::SMPLX>& body) {
+                BodyT& body) {
             // Shape space is not compatible, so we do nothing
         }
+        template<class BodyT>
         static void set_pose(const Sequence<SequenceConfig>& seq,
-                Body<model_config::SMPLX>& body, size_t frame) {
+                BodyT& body, size_t frame) {
             constexpr size_t n_body_common = SequenceConfig::n_body_joints() * 3;
             constexpr size_t n_hand_common = SequenceConfig::n_hand_joints() * 6;
             body.trans().noalias() = seq.trans.row(frame).transpose();
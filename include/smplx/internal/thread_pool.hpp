@@ -0,0 +1,101 @@
+#pragma once
+#ifndef SMPLX_INTERNAL_THREAD_POOL_4BC19B1B_0D6E_45CB_A4EE_F0F4F4027221
+#define SMPLX_INTERNAL_THREAD_POOL_4BC19B1B_0D6E_45CB_A4EE_F0F4F4027221
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace smplx {
+namespace internal {
+
+// Simple fork-join thread pool used for the CPU LBS path.
+// parallel_for may be called concurrently from several threads and from
+// inside a running task; the calling thread always helps with its own work,
+// and no memory is allocated per call.
+class ThreadPool {
+public:
+    // n_threads: total number of threads, including the calling thread
+    explicit ThreadPool(size_t n_threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) =delete;
+    ThreadPool& operator=(const ThreadPool&) =delete;
+
+    // Total number of threads, including the calling thread
+    inline size_t size() const { return _threads.size() + 1; }
+
+    // Change number of threads; must not be called while work is running
+    void resize(size_t n_threads);
+
+    // Call func(chunk_begin, chunk_end) over disjoint chunks covering [begin, end)
+    // grain: minimum chunk size
+    template<class Func>
+    void parallel_for(size_t begin, size_t end, size_t grain, Func&& func) {
+        if (end <= begin) return;
+        const size_t n = end - begin;
+        size_t chunk = (n + 4 * size() - 1) / (4 * size());
+        if (chunk < grain) chunk = grain;
+        if (_threads.empty() || chunk >= n) {
+            func(begin, end);
+            return;
+        }
+        using FuncType = typename std::remove_reference<Func>::type;
+        Job job;
+        job.fn = [](void* ctx, size_t b, size_t e) {
+            (*static_cast<FuncType*>(ctx))(b, e);
+        };
+        job.ctx = static_cast<void*>(&func);
+        job.begin = begin;
+        job.end = end;
+        job.chunk = chunk;
+        _run(job);
+    }
+
+private:
+    // A parallel_for call in progress; lives on the caller's stack
+    struct Job {
+        void (*fn)(void*, size_t, size_t);
+        void* ctx;
+        size_t begin, end, chunk;
+        std::atomic<size_t> next{0};
+        // Number of threads currently working on the job, guarded by _mutex
+        size_t n_active = 0;
+        Job* next_job = nullptr;
+    };
+
+    void _run(Job& job);
+    // Execute chunks of job until none are left
+    void _work_on(Job& job);
+    // Remove job from queue if present; _mutex must be held
+    void _unlink(Job& job);
+    void _start(size_t n_threads);
+    void _stop();
+    void _worker();
+
+    std::vector<std::thread> _threads;
+    std::mutex _mutex;
+    std::condition_variable _cv_work, _cv_done;
+    Job* _jobs = nullptr;
+    bool _stopping = false;
+};
+
+// Process-wide thread pool used by Body/BodyBatch,
+// size can be set with util::set_num_threads
+ThreadPool& thread_pool();
+
+// parallel_for on the process-wide thread pool
+template<class Func>
+inline void parallel_for(size_t begin, size_t end, size_t grain, Func&& func) {
+    thread_pool().parallel_for(begin, end, grain, std::forward<Func>(func));
+}
+
+}  // namespace internal
+}  // namespace smplx
+
+#endif  // ifndef SMPLX_INTERNAL_THREAD_POOL_4BC19B1B_0D6E_45CB_A4EE_F0F4F4027221
@@ -0,0 +1,55 @@
+#pragma once
+#ifndef SMPLX_INTERNAL_UV_MAP_8D1E4C62_93A7_4B0F_B5D8_2F6C17E0A943
+#define SMPLX_INTERNAL_UV_MAP_8D1E4C62_93A7_4B0F_B5D8_2F6C17E0A943
+
+// UV maps, from a text file (see data/models/smplx/uv.txt) or a binary
+// sidecar: a .smplxbin file (see model_file.hpp) holding only the arrays
+// uv (n_uv_verts, 2) f32 and uv_triangles (n_faces, 3) u32, which is
+// memory-mapped instead of parsed
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "smplx/defs.hpp"
+
+namespace smplx {
+namespace internal {
+
+// Read-only UV map
+struct UVMap {
+    // UV coordinates, (n_uv_verts, 2) row-major
+    const Scalar* uv = nullptr;
+    size_t n_uv_verts = 0;
+    // Indices in uv of the corners of each face, (n_faces, 3) row-major
+    const Index* triangles = nullptr;
+    size_t n_faces = 0;
+    // Mapping or parsed arrays backing the data
+    std::shared_ptr<const void> storage;
+};
+
+// Load UV map from path, a text file or binary sidecar (.smplxbin).
+// For a text file, an up-to-date sidecar with the same name and extension
+// .smplxbin (e.g. uv.smplxbin next to uv.txt) is used instead if present.
+// Maps stay cached by path while in use, so reloading a model (e.g. to switch
+// gender) does not read the file again.
+// Returns nullptr if path is empty or does not exist;
+// exits with an error message if the file is invalid.
+std::shared_ptr<const UVMap> load_uv_map(const std::string& path);
+
+// Parse UV map in text format: n_uv_verts, n_uv_verts pairs of UV
+// coordinates, then 1-based uv indices for each face. Locale-independent.
+// source: file name, for error messages
+std::shared_ptr<const UVMap> parse_uv_map(const char* data, size_t size,
+        const std::string& source);
+
+// Save UV map as a binary sidecar; exits with an error message on failure
+void save_uv_map(const UVMap& uv_map, const std::string& path);
+
+// Sidecar path for a text UV map path (extension replaced by .smplxbin)
+std::string uv_map_sidecar_path(const std::string& path);
+
+}  // namespace internal
+}  // namespace smplx
+
+#endif  // ifndef SMPLX_INTERNAL_UV_MAP_8D1E4C62_93A7_4B0F_B5D8_2F6C17E0A943
@@ -0,0 +1,128 @@
+#pragma once
+#ifndef SMPLX_MODEL_CACHE_4F7A2C18_6B3E_4D91_8E05_C9D2A1B73F64
+#define SMPLX_MODEL_CACHE_4F7A2C18_6B3E_4D91_8E05_C9D2A1B73F64
+
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "smplx/smplx.hpp"
+
+namespace smplx {
+
+// Thread-safe cache of shared, immutable models keyed by
+// (ModelConfig, gender, path), so that code switching between models
+// (e.g. the gender of each AMASS sequence) loads each from disk only once.
+// Concurrent requests for a model not yet loaded wait for a single load.
+// Usage:
+//   auto model = ModelCache::global().get<model_config::SMPLH>(Gender::female);
+//   Body<model_config::SMPLH> body(*model);
+class ModelCache {
+public:
+    // Process-wide cache
+    static ModelCache& global();
+
+    // Get model of given gender from its default path (see Model::load(Gender)),
+    // loading it if not cached
+    template<class ModelConfig>
+    std::shared_ptr<const Model<ModelConfig>> get(Gender gender = Gender::neutral) {
+        return std::static_pointer_cast<const Model<ModelConfig>>(
+            _get(_key(ModelConfig::model_name, gender, "", ""), [gender]() {
+                auto model = std::make_shared<const Model<ModelConfig>>(gender);
+                return Entry::Value(model, model_bytes(*model));
+            }));
+    }
+
+    // Get model at path (see Model::load(path, uv_path, gender)),
+    // loading it if not cached
+    template<class ModelConfig>
+    std::shared_ptr<const Model<ModelConfig>> get(const std::string& path,
+            const std::string& uv_path = "", Gender gender = Gender::unknown) {
+        return std::static_pointer_cast<const Model<ModelConfig>>(
+            _get(_key(ModelConfig::model_name, gender, path, uv_path), [=]() {
+                auto model = std::make_shared<const Model<ModelConfig>>(path, uv_path, gender);
+                return Entry::Value(model, model_bytes(*model));
+            }));
+    }
+
+    // Load the default models of all genders (neutral, male, female) that
+    // exist, in parallel
+    template<class ModelConfig>
+    void preload() {
+        _preload([this](Gender gender) { get<ModelConfig>(gender); },
+                ModelConfig::default_path_prefix);
+    }
+
+    // Memory budget in bytes for cached models (0 = unlimited, the default).
+    // When exceeded, least recently used models are dropped from the cache;
+    // models still in use elsewhere are kept, as dropping them frees nothing.
+    void set_memory_budget(size_t bytes);
+    size_t memory_budget() const;
+
+    // Approximate memory used by cached models, in bytes
+    size_t memory_usage() const;
+
+    // Number of cached models
+    size_t size() const;
+
+    // Drop all models from the cache (models in use remain valid)
+    void clear();
+
+    // Approximate memory used by the data of a model, in bytes
+    template<class ModelConfig>
+    static size_t model_bytes(const Model<ModelConfig>& model) {
+        const auto sparse_bytes = [](size_t nnz, size_t outer) {
+            return nnz * (sizeof(Scalar) + sizeof(int)) + (outer + 1) * sizeof(int);
+        };
+        return sizeof(Scalar) * (model.verts.size() + model.blend_shapes.size() +
+                model.joints.size() + model.pose_blend_basis.size() +
+                model.pose_blend_coeffs.size() + model.blend_shapes_tiled.size() +
+                model.uv.size() +
+                model.vert_influence_weights.size()) +
+            sizeof(uint16_t) * model.blend_shapes_half.size() +
+            sizeof(Index) * (model.faces.size() + model.uv_triangles.size() +
+                model.vert_influence_joints.size()) +
+            sparse_bytes(model.joint_reg.nonZeros(), model.joint_reg.outerSize()) +
+            sparse_bytes(model.weights.nonZeros(), model.weights.outerSize()) +
+            sparse_bytes(model.weights_rowmajor.nonZeros(),
+                    model.weights_rowmajor.outerSize());
+    }
+
+private:
+    struct Entry {
+        // Model and its size in bytes
+        using Value = std::pair<std::shared_ptr<const void>, size_t>;
+        std::shared_future<Value> value;
+        // Position in _lru
+        std::list<std::string>::iterator lru_pos;
+        // Whether loaded and counted in _usage
+        bool loaded = false;
+        // Distinguishes entries re-created for a key after clear()
+        uint64_t id;
+    };
+
+    static std::string _key(const char* model_name, Gender gender,
+            const std::string& path, const std::string& uv_path);
+    std::shared_ptr<const void> _get(const std::string& key,
+            const std::function<Entry::Value()>& load);
+    void _preload(const std::function<void(Gender)>& get, const char* path_prefix);
+    // Drop least recently used models until within budget; requires lock
+    void _evict();
+
+    mutable std::mutex _mutex;
+    std::unordered_map<std::string, Entry> _entries;
+    // Keys, most recently used first
+    std::list<std::string> _lru;
+    size_t _budget = 0, _usage = 0;
+    uint64_t _next_id = 0;
+};
+
+}  // namespace smplx
+
+#endif  // ifndef SMPLX_MODEL_CACHE_4F7A2C18_6B3E_4D91_8E05_C9D2A1B73F64
@@ -8,6 +8,92 @@ namespace smplx {
 namespace model_config {
 
 namespace internal {
+// Fixed-size array usable in constexpr functions (C++14, unlike std::array)
+template<class T, size_t N>
+struct ConstArray {
+    T data[N];
+    constexpr T& operator[](size_t i) { return data[i]; }
+    constexpr const T& operator[](size_t i) const { return data[i]; }
+    static constexpr size_t size() { return N; }
+};
+
+// Evaluation schedule of a kinematic tree with N joints, derived from the
+// parent array at compile time (see ModelConfigBase::kinematic_schedule)
+template<size_t N>
+struct KinematicSchedule {
+    // True if parent[0] == 0 and parent[i] < i for i > 0, i.e. the joint
+    // index order is topological; all other members are only valid if true
+    bool parents_ordered;
+    // Depth of each joint in the tree (root is 0)
+    ConstArray<size_t, N> depth;
+    // Number of distinct depths
+    size_t n_levels;
+    // Joints sorted by depth (ties by index), a topological order in which
+    // all joints of a level can be processed together
+    ConstArray<size_t, N> level_order;
+    // Joints at depth d are level_order[level_begin[d]..level_begin[d+1]-1]
+    ConstArray<size_t, N + 1> level_begin;
+    // Position in level_order of the parent of level_order[k] (0 for the root)
+    ConstArray<size_t, N> level_parent_pos;
+    // Joints in depth-first pre-order (children by index), a topological order
+    // in which every subtree is contiguous
+    ConstArray<size_t, N> dfs_order;
+    // Subtree rooted at joint i (including i) is
+    // dfs_order[subtree_begin[i]..subtree_end[i]-1]
+    ConstArray<size_t, N> subtree_begin, subtree_end;
+};
+
+template<size_t N>
+constexpr KinematicSchedule<N> make_kinematic_schedule(const size_t (&parent)[N]) {
+    KinematicSchedule<N> sched{};
+    sched.parents_ordered = parent[0] == 0;
+    for (size_t i = 1; i < N; ++i) {
+        if (parent[i] >= i) sched.parents_ordered = false;
+    }
+    if (!sched.parents_ordered) return sched;
+
+    // Depths
+    sched.n_levels = 1;
+    for (size_t i = 1; i < N; ++i) {
+        sched.depth[i] = sched.depth[parent[i]] + 1;
+        if (sched.depth[i] >= sched.n_levels) sched.n_levels = sched.depth[i] + 1;
+    }
+
+    // Level order (counting sort by depth)
+    ConstArray<size_t, N> level_pos{};
+    size_t k = 0;
+    for (size_t d = 0; d < sched.n_levels; ++d) {
+        sched.level_begin[d] = k;
+        for (size_t i = 0; i < N; ++i) {
+            if (sched.depth[i] == d) {
+                level_pos[i] = k;
+                sched.level_order[k++] = i;
+            }
+        }
+    }
+    for (size_t d = sched.n_levels; d <= N; ++d) sched.level_begin[d] = N;
+    for (k = 1; k < N; ++k) {
+        sched.level_parent_pos[k] = level_pos[parent[sched.level_order[k]]];
+    }
+
+    // Subtree sizes, then depth-first positions: children of each joint are
+    // placed one after another right after it
+    ConstArray<size_t, N> subtree_size{}, next_pos{};
+    for (size_t i = 0; i < N; ++i) subtree_size[i] = 1;
+    for (size_t i = N - 1; i > 0; --i) subtree_size[parent[i]] += subtree_size[i];
+    next_pos[0] = 1;
+    for (size_t i = 1; i < N; ++i) {
+        sched.subtree_begin[i] = next_pos[parent[i]];
+        next_pos[parent[i]] += subtree_size[i];
+        next_pos[i] = sched.subtree_begin[i] + 1;
+    }
+    for (size_t i = 0; i < N; ++i) {
+        sched.subtree_end[i] = sched.subtree_begin[i] + subtree_size[i];
+        sched.dfs_order[sched.subtree_begin[i]] = i;
+    }
+    return sched;
+}
+
 template<class Derived>
 struct ModelConfigBase {
     static constexpr size_t n_joints() {
@@ -25,6 +111,11 @@ struct ModelConfigBase {
     }
     static constexpr size_t n_hand_pca_joints() { return 0; }
     static constexpr size_t n_hand_pca() { return 0; }
+    // Kinematic tree evaluation schedule from parent[], for use in constant
+    // expressions, e.g. static constexpr auto sched = Config::kinematic_schedule();
+    static constexpr auto kinematic_schedule() {
+        return make_kinematic_schedule(Derived::parent);
+    }
 };
 }  // namespace internal
 
@@ -5,7 +5,11 @@
 #include "smplx/smplx.hpp"
 #include "smplx/sequence_config.hpp"
 #include "smplx/internal/sequence_model_spec.hpp"
+
+#include <memory>
+
 namespace smplx {
+namespace internal { class NpzReader; }
 
 // Note: SequenceModelSpec is in smplx/internal/sequence_model_spec.hpp
 
@@ -28,6 +32,23 @@ public:
     // Returns true on success
     bool load(const std::string& path);
 
+    // Fields of per-frame data, for read_frames
+    enum Field { TRANS = 1, POSE = 2, DMPLS = 4, ALL_FIELDS = 7 };
+
+    // Open sequence from AMASS-like .npz without reading per-frame data:
+    // reads n_frames, frame_rate, gender and shape only, and keeps the file
+    // open for read_frames. trans, pose and dmpls are left empty.
+    // Returns true on success
+    bool open(const std::string& path);
+
+    // Read frames [begin, begin + count) of the given fields (bitwise OR
+    // of Field) of the sequence opened with open() into trans, pose and
+    // dmpls, whose row 0 is then frame begin; fields not requested are
+    // emptied. Costs are proportional to count for uncompressed npz, and,
+    // for compressed npz, to count plus the distance from the nearest
+    // access point recorded by previous reads of the same field
+    void read_frames(size_t begin, size_t count, int fields = ALL_FIELDS);
+
     // Set body shape
     template<class ModelConfig> inline void set_shape(Body<ModelConfig>& body) {
         internal::SequenceModelSpec<SequenceConfig, ModelConfig>::set_shape(*this, body);
@@ -35,13 +56,41 @@ public:
     // Set body pose
     template<class ModelConfig> inline void set_pose(
             Body<ModelConfig>& body, size_t frame) {
-        internal::SequenceModelSpec<SequenceConfig, ModelConfig>::set_pose(*this, body, frame);
+        internal::SequenceModelSpec<SequenceConfig, ModelConfig>::set_pose(*this, body,
+                frame - frame_begin);
     }
 
+    // Deform the body of model for all frames held in trans/pose at once,
+    // see evaluate(model, out_verts, out_joints, begin, count)
+    template<class ModelConfig>
+    void evaluate(const Model<ModelConfig>& model, Scalar* out_verts,
+            Scalar* out_joints = nullptr, bool enable_pose_blendshapes = true) const {
+        evaluate(model, out_verts, out_joints, frame_begin, trans.rows(),
+                enable_pose_blendshapes);
+    }
+
+    // Deform the body of model for frames [begin, begin + count), which must
+    // be held in trans/pose, in one call; equivalent to set_shape, then
+    // set_pose and Body::update(true) for each frame, but much faster: shape
+    // blend shapes are applied once, pose blend shapes of blocks of frames in
+    // one matrix product, and kinematics and LBS in parallel over frames.
+    // CPU only. Supports the models supported by set_pose.
+    // -> out_verts: (count, #verts, 3) contiguous, vertices of each frame
+    // -> out_joints: (count, #joints, 3) contiguous, joints of each frame;
+    //                may be null
+    template<class ModelConfig>
+    void evaluate(const Model<ModelConfig>& model, Scalar* out_verts,
+            Scalar* out_joints, size_t begin, size_t count,
+            bool enable_pose_blendshapes = true) const;
+
     // * METADATA
     // Number of frames in sequence
     size_t n_frames;
 
+    // First frame held in trans, pose and dmpls: 0 after load(),
+    // set by read_frames. set_pose takes frame numbers in the sequence.
+    size_t frame_begin = 0;
+
     // Mocap frame rate
     double frame_rate;
     // Gender, may be unknown
@@ -59,6 +108,10 @@ public:
 
     // DMPLs
     Eigen::Matrix<Scalar, Eigen::Dynamic, SequenceConfig::n_dmpls(), Eigen::RowMajor> dmpls;
+
+private:
+    // File opened by open(), shared by copies
+    std::shared_ptr<internal::NpzReader> _npz;
 };
 
 // An AMASS sequence
@@ -5,6 +5,7 @@
 #include "smplx/defs.hpp"
 #include "smplx/model_config.hpp"
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -12,6 +13,10 @@
         inline auto name() const {return body;}
 
 namespace smplx {
+namespace internal {
+class ModelFileWriter;
+struct UVMap;
+}  // namespace internal
 #ifdef SMPLX_CUDA_ENABLED
 namespace internal {
 // Basic CSR sparse matrix repr
@@ -30,11 +35,11 @@ struct GPUSparseMatrix {
 template<class ModelConfig>
 class Model {
 public:
-    // Construct from .npz at default path for given gender
+    // Construct from .smplxbin or .npz at default path for given gender
     explicit Model(Gender gender = Gender::neutral);
 
-    // Construct from .npz at path (standard SMPL-X npz format)
-    // path: .npz model path, in data/models/smplx/*.npz
+    // Construct from .smplxbin or .npz at path (standard SMPL-X npz format)
+    // path: .smplxbin or .npz model path, in data/models/smplx/
     // uv_path: UV map information path, see data/models/smplx/uv.txt for an example
     // gender: records gender of model. For informational purposes only.
     explicit Model(const std::string& path,
@@ -42,24 +47,113 @@ public:
                    Gender gender = Gender::unknown);
     ~Model();
 
-    // Load from .npz at default path for given gender
+    // Load from default path for given gender, preferring .smplxbin over .npz
+    // (unless the .npz is newer, then loads it with a warning)
     // useful for dynamically switching genders
     void load(Gender gender = Gender::neutral);
-    // Load from .npz at path (standard SMPL-X npz format)
-    // path: .npz model path, in data/models/smplx/*.npz
-    // uv_path: UV map information path, see data/models/smplx/uv.txt for an example
+    // Load from .smplxbin or .npz at path (standard SMPL-X npz format)
+    // A .smplxbin file (see save) is memory-mapped and used in place: the data
+    // members below are views into the mapping, so loading does not parse or
+    // copy the large arrays, and processes mapping the same file share pages.
+    // path: .smplxbin or .npz model path, in data/models/smplx/
+    // uv_path: UV map information path, see data/models/smplx/uv.txt for an example;
+    //          a binary uv.smplxbin next to it (see smplx-convert) is used if up to date;
+    //          ignored if the .smplxbin file contains a UV map
     // gender: records gender of model. For informational purposes only.
     void load(const std::string& path,
                    const std::string& uv_path = "",
                    Gender new_gender = Gender::unknown);
 
+    // Save to path in the native binary format (.smplxbin), to be used by load.
+    // Includes the UV map, if any.
+    void save(const std::string& path) const;
+
+    // Publish the model into a named POSIX shared memory segment
+    // (e.g. "/smplx_x_neutral"), in the .smplxbin format, so that other
+    // processes can attach() to it instead of loading their own copy.
+    // Replaces any existing segment of the same name. The segment persists
+    // until unpublish(name) (or reboot), also after this process exits.
+    void publish(const std::string& name) const;
+
+    // Load by attaching read-only to a shared memory segment created by
+    // publish(); as with .smplxbin files, the data members are views into
+    // the segment, so there is no parsing or copying and all attached
+    // processes share the same physical pages
+    void attach(const std::string& name, Gender new_gender = Gender::unknown);
+
+    // Remove a shared memory segment created by publish(); models already
+    // attached to it stay valid
+    static void unpublish(const std::string& name);
+
+    // Construct by attaching to a shared memory segment created by
+    // publish(), see attach()
+    static Model attached(const std::string& name, Gender gender = Gender::unknown);
+
+    // Not copyable, since data members may be views into the model's own storage
+    Model(const Model& other) =delete;
     Model& operator=(const Model& other) =delete;
     Model& operator=(Model&& other) =delete;
 
+    // Approximate the pose-dependent blend shapes by a rank-k factorization
+    // pose_blend_basis * pose_blend_coeffs (truncated PCA), so that the CPU path of
+    // Body::update applies them as two skinny products. The setting is kept
+    // and re-applied on later load() calls. The factorization is saved in
+    // .smplxbin files; loading such a file uses it and sets the setting to its
+    // rank. GPU updates always use the full blend shapes.
+    // max_rank: maximum rank to keep; 0 means no limit
+    // tol: if > 0, use the smallest rank (up to max_rank) with relative
+    //      Frobenius norm error at most tol
+    // Returns the rank used; 0 (no compression) if the rank would not be reduced
+    size_t compress_pose_blendshapes(size_t max_rank, Scalar tol = 0.f);
+
+    // Undo compress_pose_blendshapes
+    void decompress_pose_blendshapes();
+
+    // Rank of the pose blend shape approximation, 0 if not compressed
+    inline size_t pose_blend_rank() const { return pose_blend_basis.cols(); }
+
+    // Store blend shapes in reduced precision (fp16 or bf16) to halve their
+    // memory use and the memory traffic of CPU updates; products are still
+    // accumulated in fp32. blend_shapes is released and blend_shapes_half is
+    // used instead; Precision::fp32 restores it from the reduced data.
+    // The setting is kept and re-applied on later load() calls; loading a
+    // .smplxbin file with reduced precision blend shapes sets it to the file's
+    // precision. GPU updates and low-rank pose blend shapes always use fp32.
+    void set_blend_shapes_precision(Precision precision);
+
+    // Storage precision of blend shapes
+    inline Precision blend_shapes_precision() const { return _blend_shapes_precision; }
+
+    // With BlendShapesLayout::tiled, also store the blend shapes split into
+    // tiles of vertices (blend_shapes_tiled), which the CPU path of
+    // Body::update uses to apply full-rank fp32 pose blend shapes and LBS
+    // fused per tile. Takes as much memory again as blend_shapes; not built
+    // for reduced precision blend shapes. The setting is kept and re-applied
+    // on later load() calls; the tiles are saved in .smplxbin files, and
+    // loading such a file sets it.
+    void set_blend_shapes_layout(BlendShapesLayout layout);
+
+    // Blend shape layout setting
+    inline BlendShapesLayout blend_shapes_layout() const { return _blend_shapes_layout; }
+
     // Returns true if has UV map
     inline bool has_uv_map() const { return n_uv_verts > 0; }
 
+    // Maximum number of joints influencing a vertex
+    inline size_t n_vert_influences() const { return vert_influence_weights.cols(); }
+
+    // Version of the model data; changes on every load() and every change
+    // of the blend shapes (compress_pose_blendshapes, set_blend_shapes_precision,
+    // set_blend_shapes_layout), used by Body to detect stale cached data
+    inline size_t version() const { return _version; }
+
     using Config = ModelConfig;
+    // Blend shape matrix types, see blend_shapes
+    using BlendShapes = Eigen::Matrix<Scalar, Eigen::Dynamic, Config::n_blend_shapes()>;
+    using BlendShapesHalf = Eigen::Matrix<uint16_t, Eigen::Dynamic, Config::n_blend_shapes()>;
+    // Per-vertex influence list type, see vert_influence_joints
+    using VertInfluenceJoints = Eigen::Matrix<Index, Eigen::Dynamic, Eigen::Dynamic,
+          Eigen::RowMajor>;
 
     // DATA SHAPE INFO (shorthand) from ModelConfig
 
@@ -106,24 +200,63 @@ public:
     // Kinematic tree: joint children
     std::vector<std::vector<size_t> > children;
 
+    // Large arrays are views into storage owned by the model or into a
+    // memory-mapped .smplxbin file; they are valid until the next load()
+
     // Points in the initial mesh, (#verts, 3)
-    Points verts;
+    Eigen::Map<const Points> verts{nullptr, 0, 3};
 
     // Triangles in the mesh, (#faces, 3)
-    Triangles faces;
+    Eigen::Map<const Triangles> faces{nullptr, 0, 3};
 
-    // Initial joint positions
-    Points joints;
+    // Initial joint positions, joint_reg * verts, (#joints, 3)
+    Eigen::Map<const Points> joints{nullptr, 0, 3};
 
     // Shape-dependent blend shapes, (3*#joints, #shape blends + #pose blends)
     // each col represents a point cloud (#joints, 3) in row-major order
-    Eigen::Matrix<Scalar, Eigen::Dynamic, n_blend_shapes()> blend_shapes;
+    Eigen::Map<const BlendShapes> blend_shapes{nullptr, 0, n_blend_shapes()};
+
+    // ** Low-rank pose blend shapes **, available if pose_blend_rank() > 0
+    // pose blend shapes (right #pose blends cols of blend_shapes) are approximated
+    // by pose_blend_basis (3*#verts, rank) * pose_blend_coeffs (rank, #pose blends)
+    MatrixColMajor pose_blend_basis, pose_blend_coeffs;
+    // Relative Frobenius norm error of the approximation
+    Scalar pose_blend_rel_error = 0.f;
+    // Upper bound on the error of any vertex coordinate for any pose
+    Scalar pose_blend_max_error = 0.f;
+
+    // ** Tiled blend shapes **, available if blend_shapes_layout() is tiled and
+    // blend shapes are fp32: blend_shapes in the layout of
+    // internal/blend_tiles.hpp, (#tiles * #blend shapes, BLEND_TILE_ROWS)
+    Eigen::Map<const Matrix> blend_shapes_tiled{nullptr, 0, 0};
+
+    // ** Reduced precision blend shapes **, available if
+    // blend_shapes_precision() != Precision::fp32
+    // blend_shapes as fp16/bf16 bit patterns, same layout; blend_shapes is empty
+    Eigen::Map<const BlendShapesHalf> blend_shapes_half{nullptr, 0, n_blend_shapes()};
+    // Relative Frobenius norm error of blend_shapes_half
+    Scalar blend_shapes_rel_error = 0.f;
+    // Upper bound on the error of any vertex coordinate due to the pose blend
+    // shapes, for any pose (the error due to shape blend shapes scales with
+    // the shape params)
+    Scalar blend_shapes_max_pose_error = 0.f;
 
     // Joint regressor: verts -> joints, (#joints, #verts)
-    SparseMatrix joint_reg;
+    Eigen::Map<const SparseMatrix> joint_reg{0, 0, 0, nullptr, nullptr, nullptr};
 
-    // LBS weights, (#verts, #joints)
-    SparseMatrixColMajor weights;
+    // LBS weights, (#verts, #joints); being column-major (CSC), each column
+    // lists the vertices influenced by a joint
+    Eigen::Map<const SparseMatrixColMajor> weights{0, 0, 0, nullptr, nullptr, nullptr};
+
+    // LBS weights in row-major (CSR) order, for per-vertex skinning
+    Eigen::Map<const SparseMatrix> weights_rowmajor{0, 0, 0, nullptr, nullptr, nullptr};
+
+    // LBS weights as fixed-size per-vertex influence lists: the joints
+    // influencing each vertex by decreasing weight, padded with weight 0 on
+    // joint 0, (#verts, n_vert_influences()); the first k columns are the
+    // top-k influences
+    Eigen::Map<const VertInfluenceJoints> vert_influence_joints{nullptr, 0, 0};
+    Eigen::Map<const Matrix> vert_influence_weights{nullptr, 0, 0};
 
     // ** Hand PCA data **
     // Hand PCA comps: pca -> joint pos delta
@@ -135,11 +268,70 @@ public:
 
     // ** UV Data **, available if has_uv_map()
     // UV coordinates, size (n_uv_verts, 2)
-    Points2D uv;
+    Eigen::Map<const Points2D> uv{nullptr, 0, 2};
     // UV triangles (indices in uv), size (n_faces, 3)
-    Triangles uv_triangles;
+    Eigen::Map<const Triangles> uv_triangles{nullptr, 0, 3};
+
+private:
+    // Construct by attaching to shared memory, see attached()
+    struct Attach {};
+    Model(Attach, const std::string& name, Gender gender);
+
+    size_t _version = 0;
+
+    // Storage backing the views above when not loaded from a .smplxbin file
+    // (or when changed since, e.g. by set_blend_shapes_precision)
+    Points _verts_data;
+    Triangles _faces_data;
+    BlendShapes _blend_shapes_data;
+    BlendShapesHalf _blend_shapes_half_data;
+    Matrix _blend_shapes_tiled_data;
+    SparseMatrix _joint_reg_data;
+    SparseMatrixColMajor _weights_data;
+    Points _joints_data;
+    SparseMatrix _weights_rowmajor_data;
+    VertInfluenceJoints _vert_influence_joints_data;
+    Matrix _vert_influence_weights_data;
+
+    // Memory-mapped .smplxbin file, if loaded from one
+    std::shared_ptr<const void> _mapped;
+    // UV map backing uv, uv_triangles if not from the .smplxbin file
+    std::shared_ptr<const internal::UVMap> _uv_map;
+
+    // Common parts of load() and attach()
+    void _begin_load();
+    void _finish_load();
+    // Load data from .npz / mapped .smplxbin data into the views above
+    void _load_npz(const std::string& path, const std::string& uv_path);
+    void _load_mapped(std::shared_ptr<const void> mapped, size_t size,
+            const std::string& source, const std::string& uv_path);
+    // Compute data derived from the loaded data (joints, weights_rowmajor,
+    // vertex influence lists) into owned storage; .smplxbin files store it
+    void _compute_derived();
+    // Add data to a .smplxbin file
+    void _add_arrays(internal::ModelFileWriter& file) const;
+    // Load UV map from text file or binary sidecar, see internal/uv_map.hpp
+    void _load_uv(const std::string& uv_path);
+
+    // Settings from compress_pose_blendshapes, re-applied on load
+    size_t _pose_blend_max_rank = 0;
+    Scalar _pose_blend_tol = 0.f;
+
+    // Setting from set_blend_shapes_precision, re-applied on load
+    Precision _blend_shapes_precision = Precision::fp32;
+
+    // Fill blend_shapes_half from blend_shapes and release blend_shapes
+    void _encode_blend_shapes();
+
+    // Setting from set_blend_shapes_layout, re-applied on load
+    BlendShapesLayout _blend_shapes_layout = BlendShapesLayout::column_major;
+
+    // Build or release blend_shapes_tiled according to the layout setting
+    // and precision
+    void _update_blend_shapes_tiled();
 
 #ifdef SMPLX_CUDA_ENABLED
+public:
     // ADVANCED: GPU data pointers
     struct {
         float* verts = nullptr;
@@ -175,11 +367,38 @@ public:
     ~Body();
 
     // Perform LBS and output verts
+    // The shaped template and joints are cached and only recomputed when
+    // shape() (or the model) changes, so keeping the shape fixed across updates
+    // is cheaper.
     // enable_pose_blendshapes: if false, disables pose blendshapes;
     //                          this provides a significant speedup at the cost of
     //                          worse accuracy
     void update(bool force_cpu = false, bool enable_pose_blendshapes = true);
 
+    // Incremental CPU update, for interactive editing of a few joints: only
+    // recomputes global transforms in the subtrees of joints whose rotation
+    // (or trans()) changed since the last update, applies the pose blend shape
+    // change of those joints only, and re-skins only vertices affected by
+    // either. Falls back to update(true, enable_pose_blendshapes) if there is no
+    // previous CPU update to build on, or if the shape, the model or the pose
+    // blend shape settings changed. Matches update() up to rounding error.
+    void update_incremental(bool enable_pose_blendshapes = true);
+
+    // CPU update writing deformed vertices and normals straight into
+    // caller-provided (#verts, 3) buffers, e.g. meshview::Mesh::verts_pos()
+    // and verts_norm(), replacing a copy from verts() and a normal estimation
+    // pass over the faces.
+    // Rest normals are computed once per shape and skinned with the blended
+    // joint transforms, so the (small) effect of pose blend shapes on normals
+    // is ignored. verts() is NOT updated; joints() is.
+    void update_with_normals(Eigen::Ref<Points> out_verts,
+                             Eigen::Ref<Points> out_normals,
+                             bool enable_pose_blendshapes = true);
+    // Same, into an interleaved (#verts, 8) buffer of position, uv, normal
+    // rows; the uv columns are left untouched
+    void update_with_normals(Eigen::Ref<PointsUVN> out,
+                             bool enable_pose_blendshapes = true);
+
     // Save as obj file
     void save_obj(const std::string& path) const;
 
@@ -221,10 +440,28 @@ public:
 
 private:
     // * OUTPUTS generated by update
-    // Deformed vertices (only shape applied); not available in case of GPU
-    // (only device.verts_shaped)
+    // Deformed vertices (shape and pose blend shapes applied, before LBS);
+    // not available in case of GPU (only device.verts_shaped)
     Points _verts_shaped;
 
+    // Deformed vertices (only shape applied); cached, see _check_shape_cache
+    Points _verts_shape_only;
+
+    // Unit normals of _verts_shape_only, used by update_with_normals;
+    // computed on demand
+    Points _normals_shape_only;
+    bool _normals_shape_only_valid = false;
+
+    // Shape params followed by pose blend shape params of the last update
+    Vector _blendshape_params;
+
+    // Scratch space for low-rank pose blend shapes, kept to avoid allocating
+    // on every update
+    MatrixColMajor _pose_latent;
+
+    // Local joint rotations of the last update, (#joints, 12) as _joint_transforms
+    Eigen::Matrix<Scalar, Eigen::Dynamic, 12, Eigen::RowMajor> _local_transforms;
+
     // Deformed vertices (shape and pose applied)
     mutable Points _verts;
 
@@ -236,18 +473,47 @@ private:
 
     // Deformed joints (shape and pose applied)
     mutable Points _joints;
-	
+
+    // Shape params and model.version() the shape cache was last checked
+    // against
+    Eigen::Matrix<Scalar, ModelConfig::n_shape_blends(), 1> _cached_shape;
+    size_t _cached_model_version = 0;
+    // True if _verts_shape_only and _joints_shaped are up to date (CPU path)
+    bool _shape_cache_valid = false;
+
+    // State of the last CPU update, used by update_incremental
+    bool _incremental_valid = false;
+    bool _last_enable_pose_blendshapes;
+    size_t _last_pose_blend_rank;
+    Vector3f _last_trans;
+    // Per-vertex flags: needs to be re-skinned by update_incremental
+    std::vector<char> _verts_dirty;
+
+    // Compute blend shape params and local transforms from params and
+    // check the shape cache; the start of every update
+    void _begin_update();
+
+    // CPU part of update: blend shapes, global transforms and LBS into
+    // out_verts; also skins _normals_shape_only into out_normals if not empty
+    void _update_cpu(bool enable_pose_blendshapes, Eigen::Ref<Points> out_verts,
+                     Eigen::Ref<Points> out_normals);
+
 	// Transform local to global coordinates
 	// Inputs: trans(), _joints_shaped
 	// Outputs: _joints
 	// Input/output: _joint_transforms
 	void _local_to_global();
 
+    // Invalidate the shape cache if shape() or the model changed since the
+    // last call
+    void _check_shape_cache();
+
 #ifdef SMPLX_CUDA_ENABLED
 public:
     struct {
         float* verts = nullptr;
         float* verts_shaped = nullptr;
+        float* verts_shape_only = nullptr;
         float* joints_shaped = nullptr;
         // Internal temp
         float* verts_tmp = nullptr;
@@ -263,6 +529,8 @@ private:
     mutable bool _verts_retrieved;
 	// True if last update made use of the GPU
     bool _last_update_used_gpu;
+    // True if device.verts_shape_only and _joints_shaped are up to date
+    bool _shape_cache_valid_gpu = false;
 	// Cuda helpers
     void _cuda_load();
     void _cuda_free();
@@ -282,6 +550,101 @@ using BodyX = Body<model_config::SMPLX>;
 // SMPL-X Body with hand PCA
 using BodyXpca = Body<model_config::SMPLXpca>;
 
+// A batch of SMPL instances sharing one model, updated together.
+// Blend shapes for the whole batch are applied in a single matrix-matrix product,
+// which is much faster than calling Body::update once per body. CPU only.
+template<class ModelConfig>
+class BodyBatch {
+public:
+    // Construct batch of bodies from model
+    // set_zero: set to false to leave parameter array uninitialized
+    explicit BodyBatch(const Model<ModelConfig>& model, size_t batch_size,
+                       bool set_zero = true);
+
+    // Perform LBS for all bodies in the batch and output verts
+    // enable_pose_blendshapes: if false, disables pose blendshapes (see Body::update)
+    void update(bool enable_pose_blendshapes = true);
+
+    // Change the number of bodies; parameters of added bodies are set to zero
+    void resize(size_t batch_size);
+
+    // Number of bodies in the batch
+    inline size_t batch_size() const { return params.rows(); }
+
+    using Config = ModelConfig;
+
+    // Parameter accessors for body i (maps to parts of params.row(i))
+    // Base position (translation)
+    inline auto trans(size_t i) {
+        return params.row(i).template head<3>().transpose(); }
+    // Pose (angle-axis)
+    inline auto pose(size_t i) {
+        return params.row(i).template segment<ModelConfig::n_explicit_joints() * 3>(3)
+            .transpose(); }
+    // Hand principal component weights
+    inline auto hand_pca(size_t i) {
+        return params.row(i).template segment<ModelConfig::n_hand_pca() * 2>(
+                3 + 3 * ModelConfig::n_explicit_joints()).transpose(); }
+    // Shape params
+    inline auto shape(size_t i) {
+        return params.row(i).template tail<ModelConfig::n_shape_blends()>().transpose(); }
+
+    // * OUTPUTS accessors; must call update() before these are available
+    // Deformed vertices of body i, in same order as model.verts
+    inline Eigen::Map<const Points> verts(size_t i) const {
+        return Eigen::Map<const Points>(_verts.row(i).data(), model.n_verts(), 3);
+    }
+    // Deformed joints of body i, in same order as model.joints
+    inline Eigen::Map<const Points> joints(size_t i) const {
+        return Eigen::Map<const Points>(_joints.row(i).data(), model.n_joints(), 3);
+    }
+    // Deformed vertices of all bodies, (#batch, 3*#verts)
+    // each row is a point cloud (#verts, 3) in row-major order
+    inline const Matrix& verts() const { return _verts; }
+    // Deformed joints of all bodies, (#batch, 3*#joints)
+    inline const Matrix& joints() const { return _joints; }
+
+    // Set parameters to zero
+    inline void set_zero() { params.setZero(); }
+
+    // Set parameters uar in [-0.25, 0.25]
+    inline void set_random() { params.setRandom(); params *= 0.25f; }
+
+    // The SMPL model used
+    const Model<ModelConfig>& model;
+
+    // * INPUTS
+    // Parameters, (#batch, #params); each row is laid out as Body::params
+    Matrix params;
+
+private:
+    // Blend shape params for all bodies, (#blend shapes, #batch)
+    MatrixColMajor _blendshape_params;
+
+    // Vertices after blend shapes but before LBS, (3*#verts, #batch)
+    MatrixColMajor _verts_shaped;
+
+    // Scratch space for low-rank pose blend shapes
+    MatrixColMajor _pose_latent;
+
+    // Joints with only shape applied, (#batch * #joints, 3)
+    Points _joints_shaped;
+
+    // Homogeneous transforms at each joint of each body, (#batch * #joints, 12)
+    Eigen::Matrix<Scalar, Eigen::Dynamic, 12, Eigen::RowMajor> _joint_transforms;
+
+    // Deformed vertices (#batch, 3*#verts) and joints (#batch, 3*#joints)
+    Matrix _verts, _joints;
+};
+// SMPL Body batch
+using BodyBatchS = BodyBatch<model_config::SMPL>;
+// SMPL-H Body batch
+using BodyBatchH = BodyBatch<model_config::SMPLH>;
+// SMPL-X Body batch with hand joint rotations
+using BodyBatchX = BodyBatch<model_config::SMPLX>;
+// SMPL-X Body batch with hand PCA
+using BodyBatchXpca = BodyBatch<model_config::SMPLXpca>;
+
 }  // namespace smpl
 
 #endif  // ifndef SMPLX_SMPLX_3F77A808_CB46_4AF6_A5FD_70CF554F8871
@@ -81,6 +81,15 @@ inline void inv_homogeneous(const Eigen::Ref<const Eigen::Matrix<T, 3, 4, Option
     a.template rightCols<1>() = - a.template leftCols<3>() * a.template rightCols<1>();
 }
 
+// Set number of threads used by the CPU LBS path (Body, BodyBatch),
+// including the calling thread. Default is the SMPLX_NUM_THREADS environment
+// variable if set, else OMP_NUM_THREADS, else the number of CPUs the process
+// may run on; set to 1 when running one process per core.
+// Do not call while an update is running.
+void set_num_threads(size_t n_threads);
+// Get number of threads used by the CPU LBS path
+size_t get_num_threads();
+
 // Path resolve helper
 std::string find_data_file(const std::string& data_path);
 
@@ -7,9 +7,11 @@
 #include <iostream>
 #include <algorithm>
 #include <chrono>
+#include <memory>
 #include <Eigen/Geometry>
 
 #include "smplx/smplx.hpp"
+#include "smplx/model_cache.hpp"
 #include "smplx/sequence.hpp"
 #include "smplx/util.hpp"
 #include "meshview/viewer.hpp"
@@ -25,22 +27,24 @@ static int run(std::string path) {
     SequenceAMASS amass(path);
     Gender gender = amass.gender;
 
-    // * Construct SMPL body model
-    Model<ModelConfig> model(gender);
-    Body<ModelConfig> body(model);
+    // * Get SMPL body model; each gender is loaded once, then shared
+    //   from the cache when switching between sequences
+    std::shared_ptr<const Model<ModelConfig>> model =
+        ModelCache::global().get<ModelConfig>(gender);
+    std::unique_ptr<Body<ModelConfig>> body(new Body<ModelConfig>(*model));
 
     if (amass.n_frames) {
         // If not empty, load shape/pose
-        amass.set_shape(body);
-        amass.set_pose(body, 0);
+        amass.set_shape(*body);
+        amass.set_pose(*body, 0);
     }
-    body.update();
+    body->update();
 
     // * Set up meshview viewer
     meshview::Viewer viewer;
 
-    viewer.add(meshview::Mesh(body.verts(), model.faces))
-        .estimate_normals().set_shininess(4.f)
+    viewer.add(meshview::Mesh(body->verts(), model->faces))
+        .estimate_normals().set_shininess(4.f).set_dynamic()
         .add_texture_solid<>(1.f, 0.7f, 0.8f)
         .add_texture_solid<meshview::Texture::TYPE_SPECULAR>(0.1f, 0.1f, 0.1f);
     auto& smpl_mesh = viewer.meshes.back();
@@ -53,7 +57,7 @@ static int run(std::string path) {
     auto center_camera = [&]() {
         // Set camera's center of rotation to transformed root joint
         viewer.camera.center_of_rot = (/* model matrix */ smpl_mesh.transform *
-            /* deformed root joint */ body.joints().row(0).transpose().homogeneous())
+            /* deformed root joint */ body->joints().row(0).transpose().homogeneous())
                     .template head<3>();
     };
     viewer.camera.dist_to_center = 4.f; // Zoom out a little
@@ -70,11 +74,9 @@ static int run(std::string path) {
     auto update_frame = [&]() {
         if (amass.n_frames == 0)
             return; // Empty sequence
-        amass.set_pose(body, (size_t)frame);
-        body.update();
-        smpl_mesh.verts_pos().noalias() = body.verts();
-        smpl_mesh.faces.noalias() = model.faces;
-        smpl_mesh.estimate_normals(); // Need to recompute normals
+        amass.set_pose(*body, (size_t)frame);
+        // Write skinned positions and normals directly into the mesh
+        body->update_with_normals(smpl_mesh.verts_pos(), smpl_mesh.verts_norm());
         // Update the mesh on-the-fly without remaking the VAO
         // (without this call, rendered mesh wouldn't change)
         smpl_mesh.update();
@@ -140,8 +142,8 @@ static int run(std::string path) {
         ImGui::SetNextWindowPos(ImVec2(10, 10), ImGuiCond_Once);
         ImGui::SetNextWindowSize(ImVec2(300, 180), ImGuiCond_Once);
         ImGui::Begin("Control", NULL);
-        ImGui::Text("Model: %s  Gender: %s", model.name(),
-                util::gender_to_str(model.gender));
+        ImGui::Text("Model: %s  Gender: %s", model->name(),
+                util::gender_to_str(model->gender));
         if (amass.n_frames) {
             ImGui::TextWrapped("Seq: %s", path.c_str());
             ImGui::Text("Frame %i (%i total)", frame, (int)amass.n_frames);
@@ -181,13 +183,15 @@ static int run(std::string path) {
             // Load new sequence
             path = open_file_dialog.GetSelected().string();
             amass.load(path);
-            amass.set_shape(body);
 
             if (amass.gender != gender) {
-                // Have to change the gender
-                model.load(amass.gender);
+                // Have to change the gender; the model is loaded only the
+                // first time each gender is used
+                model = ModelCache::global().get<ModelConfig>(amass.gender);
+                body.reset(new Body<ModelConfig>(*model));
                 gender = amass.gender;
             }
+            amass.set_shape(*body);
             open_file_dialog.ClearSelected();
             update_frame();
             viewer.loop_wait_events = true;
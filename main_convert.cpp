@@ -0,0 +1,215 @@
+// Converts SMPL model .npz files to the native binary format (.smplxbin),
+// which Model loads by memory-mapping with no parsing or copying, and reports
+// the size of the result and the load time of both files
+// Options (before the arguments):
+//   --fp16, --bf16: store blend shapes in reduced precision
+//   --pose-rank k, --pose-tol t: store a low-rank approximation of the pose
+//       blend shapes, see Model::compress_pose_blendshapes
+//   --tiled: also store the blend shapes in the vertex-tiled layout, see
+//       Model::set_blend_shapes_layout; fp32 only, so not with --fp16/--bf16
+// Arguments:
+// 1. model type, options: S H X (SMPL SMPL-H SMPL-X)
+// 2. input .npz path. If not specified, converts the model of each gender
+//    at the default path (e.g. data/models/smplx/SMPLX_NEUTRAL.npz) to a
+//    .smplxbin next to it, which Model(gender) then loads instead
+// 3. output .smplxbin path, default: input path with extension replaced
+// 4. UV map path, default: the model type's default UV map if available
+// With model type "uv", converts a text UV map (default: those of each model
+// type) to a binary sidecar (default: e.g. uv.smplxbin next to uv.txt), which
+// is then used when the text UV map is loaded
+// With model type "verify", checks the checksums of all arrays in the given
+// .smplxbin files
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "smplx/smplx.hpp"
+#include "smplx/util.hpp"
+#include "smplx/internal/model_file.hpp"
+#include "smplx/internal/uv_map.hpp"
+
+using namespace smplx;
+
+static std::string replace_extension(const std::string& path) {
+    const size_t dot = path.find_last_of('.');
+    const size_t slash = path.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+        return path + ".smplxbin";
+    return path.substr(0, dot) + ".smplxbin";
+}
+
+// Conversion options
+struct Options {
+    Precision precision = Precision::fp32;
+    size_t pose_rank = 0;
+    float pose_tol = 0.f;
+    BlendShapesLayout layout = BlendShapesLayout::column_major;
+};
+
+static double megabytes(size_t bytes) { return bytes / (1024. * 1024.); }
+
+static size_t file_size(const std::string& path) {
+    std::ifstream ifs(path, std::ios::binary | std::ios::ate);
+    return ifs ? static_cast<size_t>(ifs.tellg()) : 0;
+}
+
+// Print the arrays of a .smplxbin file with their sizes
+static void print_arrays(const std::string& path) {
+    static const char* DTYPE_NAMES[] = {"f32", "i32", "u32", "f16", "bf16"};
+    size_t size;
+    std::shared_ptr<const void> mapped = internal::map_file(path, size);
+    internal::ModelFileView file(mapped.get(), size, path);
+    for (size_t i = 0; i < file.header().n_arrays; ++i) {
+        const internal::ModelFileArray& arr = file.arrays()[i];
+        std::string shape = std::to_string(arr.shape[0]);
+        if (arr.ndim > 1) shape += "x" + std::to_string(arr.shape[1]);
+        std::printf("    %-24s %-4s %-12s %9.3f MB\n", arr.name,
+                arr.dtype < 5 ? DTYPE_NAMES[arr.dtype] : "?", shape.c_str(),
+                megabytes(arr.nbytes));
+    }
+}
+
+template<class ModelConfig>
+static void convert(const std::string& in_path, const std::string& out_path,
+        const std::string& uv_path, const Options& opts) {
+    using Clock = std::chrono::high_resolution_clock;
+    const auto elapsed_ms = [](Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    };
+    auto start = Clock::now();
+    Model<ModelConfig> model(in_path, uv_path);
+    const double npz_load_ms = elapsed_ms(start);
+    if (opts.pose_rank || opts.pose_tol > 0.f) {
+        model.compress_pose_blendshapes(opts.pose_rank, opts.pose_tol);
+    }
+    model.set_blend_shapes_precision(opts.precision);
+    model.set_blend_shapes_layout(opts.layout);
+    model.save(out_path);
+    std::cout << in_path << " -> " << out_path <<
+        (model.has_uv_map() ? " (with UV map)" : "") << "\n";
+
+    start = Clock::now();
+    Model<ModelConfig> converted(out_path);
+    const double bin_load_ms = elapsed_ms(start);
+    std::printf("  size: %.2f MB -> %.2f MB\n", megabytes(file_size(in_path)),
+            megabytes(file_size(out_path)));
+    std::printf("  load time: %.1f ms (.npz) -> %.2f ms (.smplxbin)\n",
+            npz_load_ms, bin_load_ms);
+    if (model.blend_shapes_precision() != Precision::fp32) {
+        std::printf("  %s blend shapes: relative error %g, max pose vertex error %g\n",
+                model.blend_shapes_precision() == Precision::fp16 ? "fp16" : "bf16",
+                model.blend_shapes_rel_error, model.blend_shapes_max_pose_error);
+    }
+    if (model.pose_blend_rank()) {
+        std::printf("  pose blend shapes rank %zu: relative error %g, max vertex error %g\n",
+                model.pose_blend_rank(), model.pose_blend_rel_error,
+                model.pose_blend_max_error);
+    }
+    print_arrays(out_path);
+}
+
+template<class ModelConfig>
+static int run(const std::vector<std::string>& args, const Options& opts) {
+    std::string uv_path = args.size() > 4 ? args[4] :
+        util::find_data_file(ModelConfig::default_uv_path);
+    if (!std::ifstream(uv_path)) uv_path.clear();
+    if (args.size() > 2) {
+        convert<ModelConfig>(args[2],
+                args.size() > 3 ? args[3] : replace_extension(args[2]), uv_path, opts);
+        return 0;
+    }
+    for (Gender gender : {Gender::neutral, Gender::male, Gender::female}) {
+        const std::string path = util::find_data_file(
+                std::string(ModelConfig::default_path_prefix) +
+                util::gender_to_str(gender) + ".npz");
+        if (!std::ifstream(path)) continue;
+        convert<ModelConfig>(path, replace_extension(path), uv_path, opts);
+    }
+    return 0;
+}
+
+static void convert_uv(const std::string& in_path, const std::string& out_path) {
+    size_t size;
+    std::shared_ptr<const void> text = internal::map_file(in_path, size);
+    auto uv_map = internal::parse_uv_map(static_cast<const char*>(text.get()), size, in_path);
+    internal::save_uv_map(*uv_map, out_path);
+    std::cout << in_path << " -> " << out_path << "\n";
+}
+
+static int run_uv(const std::vector<std::string>& args) {
+    if (args.size() > 2) {
+        convert_uv(args[2], args.size() > 3 ? args[3] :
+                internal::uv_map_sidecar_path(args[2]));
+        return 0;
+    }
+    for (const char* default_path : {model_config::SMPL::default_uv_path,
+            model_config::SMPLH::default_uv_path, model_config::SMPLX::default_uv_path}) {
+        const std::string path = util::find_data_file(default_path);
+        if (!std::ifstream(path)) continue;
+        convert_uv(path, internal::uv_map_sidecar_path(path));
+    }
+    return 0;
+}
+
+static int run_verify(const std::vector<std::string>& args) {
+    for (size_t i = 2; i < args.size(); ++i) {
+        size_t size;
+        std::shared_ptr<const void> mapped = internal::map_file(args[i], size);
+        internal::ModelFileView file(mapped.get(), size, args[i]);
+        file.verify_all();
+        std::cout << args[i] << ": OK (" << file.header().model_name << ", " <<
+            file.header().n_arrays << " arrays)\n";
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    // Options, then positional arguments (args[0] is the program name)
+    Options opts;
+    std::vector<std::string> args = {argv[0]};
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--fp16") {
+            opts.precision = Precision::fp16;
+        } else if (arg == "--bf16") {
+            opts.precision = Precision::bf16;
+        } else if (arg == "--tiled") {
+            opts.layout = BlendShapesLayout::tiled;
+        } else if (arg == "--pose-rank" && i + 1 < argc) {
+            opts.pose_rank = std::stoul(argv[++i]);
+        } else if (arg == "--pose-tol" && i + 1 < argc) {
+            opts.pose_tol = std::stof(argv[++i]);
+        } else if (arg.size() > 1 && arg[0] == '-' && args.size() == 1) {
+            std::cerr << "Unknown option '" << arg << "'\n";
+            return 1;
+        } else {
+            args.push_back(arg);
+        }
+    }
+    if (opts.layout == BlendShapesLayout::tiled && opts.precision != Precision::fp32) {
+        std::cerr << "--tiled is not supported with --fp16/--bf16, "
+            "tiled blend shapes are fp32 only\n";
+        return 1;
+    }
+    if (args.size() < 2) {
+        std::cerr << "Usage: " << argv[0] <<
+            " [--fp16|--bf16|--tiled] [--pose-rank k] [--pose-tol t]"
+            " S|H|X [input.npz [output.smplxbin [uv.txt]]]\n" <<
+            "       " << argv[0] << " uv [uv.txt [output.smplxbin]]\n" <<
+            "       " << argv[0] << " verify file.smplxbin...\n";
+        return 1;
+    }
+    if (args[1] == "uv") return run_uv(args);
+    if (args[1] == "verify") return run_verify(args);
+    switch (std::toupper(args[1][0])) {
+        case 'S': return run<model_config::SMPL>(args, opts);
+        case 'H': return run<model_config::SMPLH>(args, opts);
+        // Converted with hand PCA, the file can be loaded as SMPLX or SMPLXpca
+        case 'X': return run<model_config::SMPLXpca>(args, opts);
+    }
+    std::cerr << "Unknown model type '" << args[1] << "'\n";
+    return 1;
+}
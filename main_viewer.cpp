@@ -36,7 +36,7 @@ _SMPLX_PROFILE(UPDATE);
 
     // Main body model
     viewer.add(meshview::Mesh(body.verts(), model.faces))
-        .estimate_normals().set_shininess(4.f)
+        .estimate_normals().set_shininess(4.f).set_dynamic()
         .add_texture_solid<>(1.f, 0.7f, 0.8f)
         .add_texture_solid<meshview::Texture::TYPE_SPECULAR>(0.1f, 0.1f, 0.1f)
         .translate(Eigen::Vector3f(0.f, 0.f, 0.f));
@@ -50,9 +50,13 @@ _SMPLX_PROFILE(UPDATE);
     auto& smpl_pc = viewer.point_clouds.back();
 
     auto update = [&]() {
-        body.update(force_cpu, pose_blends);
+#ifdef SMPLX_CUDA_ENABLED
+        if (!force_cpu) body.update(false, pose_blends);
+        else
+#endif
+        // Only recompute the part of the body affected by the edit
+        body.update_incremental(pose_blends);
         smpl_mesh.verts_pos().noalias() = body.verts();
-        smpl_mesh.faces.noalias() = model.faces;
         smpl_mesh.estimate_normals(); // Need to recompute normals
         // Update the mesh on-the-fly (send to GPU)
         smpl_mesh.update();
@@ -1,5 +1,6 @@
 #include "meshview/mesh.hpp"
 
+#include <algorithm>
 #include <iostream>
 #include <GL/glew.h>
 #include <Eigen/Geometry>
@@ -19,12 +20,74 @@ void shader_set_transform_matrices(
     shader.set_mat3("NormalMatrix", normal_matrix);
 }
 
+using TextureSet = std::array<std::vector<Texture>, Texture::__TYPE_COUNT>;
+
+// Load textures; if !init, only those not loaded yet
+void load_textures(TextureSet& textures, bool init) {
+    for (auto& tex_vec : textures) {
+        for (auto& tex : tex_vec) {
+            if (init || !~tex.id) tex.load();
+        }
+    }
+}
+
+// Generate a white 1x1 texture to tex_id, if not already generated;
+// used to fill maps if no texture provided
+void gen_blank_texture(Index& tex_id) {
+    if (~tex_id) return;
+    glGenTextures(1, &tex_id);
+    glBindTexture(GL_TEXTURE_2D, tex_id);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    Vector3f white(1.f, 1.f, 1.f);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 1, 1,
+                0, GL_RGB, GL_FLOAT, white.data());
+        glGenerateMipmap(GL_TEXTURE_2D);
+}
+
+// Bind textures (or the blank texture) and set material uniforms
+void shader_set_material(const Shader& shader, const TextureSet& textures,
+        Index& blank_tex_id, float shininess) {
+    Index tex_id = 1;
+    bool use_blank_tex = false;;
+    for(int ttype = 0; ttype < Texture::__TYPE_COUNT; ++ttype) {
+        const char* ttype_name = Texture::type_to_name(ttype);
+        auto& tex_vec = textures[ttype];
+        Index cnt  = 0;
+        for(size_t i = 0; i < tex_vec.size(); i++, tex_id++) {
+            glActiveTexture(GL_TEXTURE0 + tex_id); // Active proper texture unit before binding
+            // Now set the sampler to the correct texture unit
+            shader.set_int("material." + std::string(ttype_name)
+                    + (cnt ? std::to_string(cnt) : ""), tex_id);
+            // And finally bind the texture
+            glBindTexture(GL_TEXTURE_2D, tex_vec[i].id);
+        }
+        if (tex_vec.empty()) {
+            gen_blank_texture(blank_tex_id);
+            shader.set_int("material." + std::string(ttype_name), 0);
+            use_blank_tex = true;
+        }
+    }
+    if (use_blank_tex) {
+        glActiveTexture(GL_TEXTURE0); // Active proper texture unit before binding
+        glBindTexture(GL_TEXTURE_2D, blank_tex_id);
+    }
+    shader.set_float("material.shininess", shininess);
+}
+
 }  // namespace
 
 // *** Mesh ***
 Mesh::Mesh(size_t num_verts, size_t num_triangles) : num_verts(num_verts),
     num_triangles(num_triangles), VAO((Index)-1) {
-    verts.resize(num_verts, verts.ColsAtCompileTime);
+    pos.resize(num_verts, pos.ColsAtCompileTime);
+    uv.resize(num_verts, uv.ColsAtCompileTime);
+    norm.resize(num_verts, norm.ColsAtCompileTime);
+    stream_dirty.fill(true);
+    VBO.fill((Index)-1);
     if (~num_triangles) {
         faces.resize(num_triangles, faces.ColsAtCompileTime);
     }
@@ -82,34 +145,7 @@ void Mesh::draw(const Shader& shader, const Camera& camera) {
     }
 
     // Bind appropriate textures
-    Index tex_id = 1;
-    bool use_blank_tex = false;;
-    for(int ttype = 0; ttype < Texture::__TYPE_COUNT; ++ttype) {
-        const char* ttype_name = Texture::type_to_name(ttype);
-        auto& tex_vec = textures[ttype];
-        Index cnt  = 0;
-        for(size_t i = 0; i < tex_vec.size(); i++, tex_id++) {
-            glActiveTexture(GL_TEXTURE0 + tex_id); // Active proper texture unit before binding
-            // Retrieve texture number (the N in diffuse_textureN)
-            Index number = 0;
-
-            // Now set the sampler to the correct texture unit
-            shader.set_int("material." + std::string(ttype_name)
-                    + (cnt ? std::to_string(cnt) : ""), tex_id);
-            // And finally bind the texture
-            glBindTexture(GL_TEXTURE_2D, tex_vec[i].id);
-        }
-        if (tex_vec.empty()) {
-            gen_blank_texture();
-            shader.set_int("material." + std::string(ttype_name), 0);
-            use_blank_tex = true;
-        }
-    }
-    if (use_blank_tex) {
-        glActiveTexture(GL_TEXTURE0); // Active proper texture unit before binding
-        glBindTexture(GL_TEXTURE_2D, blank_tex_id);
-    }
-    shader.set_float("material.shininess", shininess);
+    shader_set_material(shader, textures, blank_tex_id, shininess);
 
     // Set space transform matrices
     shader_set_transform_matrices(shader, camera, transform);
@@ -128,7 +164,14 @@ void Mesh::draw(const Shader& shader, const Camera& camera) {
 }
 
 Mesh& Mesh::estimate_normals() {
-    util::estimate_normals(verts_pos(), faces, verts_norm());
+    if (!~num_triangles || faces.rows() == 0) {
+        util::estimate_normals(pos, verts_norm());
+        return *this;
+    }
+    if (!normal_estimator.same_faces(faces, num_verts)) {
+        normal_estimator.set_faces(faces, num_verts);
+    }
+    normal_estimator.estimate(pos, verts_norm());
     return *this;
 }
 
@@ -137,16 +180,17 @@ Mesh& Mesh::set_shininess(float val) {
     return *this;
 }
 
+Mesh& Mesh::set_dynamic(bool val) {
+    dynamic = val;
+    return *this;
+}
+
 void Mesh::update(bool force_init) {
     static const size_t SCALAR_SZ = sizeof(Scalar);
-    static const size_t POS_OFFSET = 0;
-    static const size_t UV_OFFSET = 3 * SCALAR_SZ;
-    static const size_t NORMALS_OFFSET = 5 * SCALAR_SZ;
-    static const size_t VERT_INDICES = verts.ColsAtCompileTime;
-    static const size_t VERT_SZ = VERT_INDICES * SCALAR_SZ;
 
-    if (verts.size() != num_verts * VERT_INDICES) {
-        std::cerr << "Invalid vertex buf size, expect " << num_verts * VERT_INDICES << "\n";
+    if (pos.rows() != (Eigen::Index)num_verts || uv.rows() != (Eigen::Index)num_verts ||
+        norm.rows() != (Eigen::Index)num_verts) {
+        std::cerr << "Invalid vertex buf size, expect " << num_verts << " rows\n";
         return;
     }
     if (~num_triangles && faces.size() != num_triangles * faces.ColsAtCompileTime) {
@@ -155,103 +199,92 @@ void Mesh::update(bool force_init) {
         return;
     }
 
-    const size_t BUF_SZ = verts.size() * SCALAR_SZ;
-    const size_t INDEX_SZ = faces.size() * SCALAR_SZ;
+    const size_t INDEX_SZ = faces.size() * sizeof(Index);
 
     // Already initialized
-    if (!force_init && ~VAO) {
-        for (auto& tex_vec : textures) {
-            for (auto& tex : tex_vec) {
-                if (!~tex.id) tex.load();
-            }
-        }
-    } else {
-        for (auto& tex_vec : textures) {
-            for (auto& tex : tex_vec) tex.load();
-        }
+    const bool init = force_init || !~VAO;
+    load_textures(textures, init);
+    if (init) {
         blank_tex_id = -1;
 
         // create buffers/arrays
         glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
+        glGenBuffers(__STREAM_COUNT, VBO.data());
         if (~num_triangles) glGenBuffers(1, &EBO);
     }
 
     glBindVertexArray(VAO);
-    // load data into vertex buffers
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    // A great thing about structs is that their memory layout is sequential for all its items.
-    // The effect is that we can simply pass a pointer to the struct and it translates perfectly to a glm::vec3/2 array which
-    // again translates to 3/2 floats which translates to a byte array.
-    glBufferData(GL_ARRAY_BUFFER, BUF_SZ, (GLvoid*) verts.data(), GL_STATIC_DRAW);
+    // load data into vertex buffers, one per attribute
+    const Scalar* stream_data[__STREAM_COUNT] = { pos.data(), uv.data(), norm.data() };
+    const int stream_cols[__STREAM_COUNT] = { 3, 2, 3 };
+    for (int i = 0; i < __STREAM_COUNT; ++i) {
+        if (!init && !stream_dirty[i]) continue;
+        const size_t BUF_SZ = num_verts * stream_cols[i] * SCALAR_SZ;
+        glBindBuffer(GL_ARRAY_BUFFER, VBO[i]);
+        if (init) {
+            glBufferData(GL_ARRAY_BUFFER, BUF_SZ, (GLvoid*) stream_data[i],
+                    dynamic && i != STREAM_UV ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
+            // set the vertex attribute pointer: 0 positions, 1 texture coords, 2 normals
+            glEnableVertexAttribArray(i);
+            glVertexAttribPointer(i, stream_cols[i], GL_FLOAT, GL_FALSE,
+                    stream_cols[i] * SCALAR_SZ, (GLvoid*)0);
+        } else {
+            // Size is fixed (num_verts is const): overwrite in place
+            glBufferSubData(GL_ARRAY_BUFFER, 0, BUF_SZ, (GLvoid*) stream_data[i]);
+        }
+        stream_dirty[i] = false;
+    }
 
     if (~num_triangles) {
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, INDEX_SZ, faces.data(), GL_STATIC_DRAW);
+        if (init) {
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, INDEX_SZ, faces.data(), GL_STATIC_DRAW);
+            uploaded_faces = faces;
+        } else if (faces != uploaded_faces) {
+            glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, INDEX_SZ, faces.data());
+            uploaded_faces = faces;
+        }
     }
-
-    // set the vertex attribute pointers
-    // vertex positions
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, VERT_SZ, (GLvoid*)POS_OFFSET);
-    // vertex texture coords
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, VERT_SZ, (GLvoid*)UV_OFFSET);
-    // vertex normals
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, VERT_SZ, (GLvoid*)NORMALS_OFFSET);
     glBindVertexArray(0);
 }
 
 void Mesh::free_bufs() {
     if (~VAO) glDeleteVertexArrays(1, &VAO);
-    if (~VBO) glDeleteBuffers(1, &VBO);
+    for (Index vbo : VBO) {
+        if (~vbo) glDeleteBuffers(1, &vbo);
+    }
     if (~num_triangles && ~EBO) glDeleteBuffers(1, &EBO);
     if (~blank_tex_id) glDeleteTextures(1, &blank_tex_id);
 }
 
-void Mesh::gen_blank_texture() {
-    if (~blank_tex_id) return;
-    glGenTextures(1, &blank_tex_id);
-    glBindTexture(GL_TEXTURE_2D, blank_tex_id);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    Vector3f white(1.f, 1.f, 1.f);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 1, 1,
-                0, GL_RGB, GL_FLOAT, white.data());
-        glGenerateMipmap(GL_TEXTURE_2D);
-}
-
 Mesh Mesh::Triangle(const Eigen::Ref<const Vector3f>& a,
                     const Eigen::Ref<const Vector3f>& b,
                     const Eigen::Ref<const Vector3f>& c) {
     Vector3f n = (b - a).cross(c - b);
-    Mesh m(3);
-    m.verts <<
+    PointsUVN verts(3, 8);
+    verts <<
         a[0], a[1], a[2], 0.f, 0.f, n[0], n[1], n[2],
         b[0], b[1], b[2], 0.f, 1.f, n[0], n[1], n[2],
         c[0], c[1], c[2], 1.f, 1.f, n[0], n[1], n[2];
-    return m;
+    return Mesh(verts.leftCols<3>(), verts.middleCols<2>(3), verts.rightCols<3>());
 }
 
 Mesh Mesh::Square(float side_len) {
-    Mesh m(4, 2);
-    m.faces << 0, 3, 1,
-                 1, 3, 2;
-    m.verts <<
+    Triangles faces(2, 3);
+    faces << 0, 3, 1,
+             1, 3, 2;
+    PointsUVN verts(4, 8);
+    verts <<
         side_len,  side_len, 0.f,   1.0f, 1.0f,        0.0f, 0.0f, 1.0f,
         side_len, -side_len, 0.f,   1.0f, 0.0f,        0.0f, 0.0f, 1.0f,
         -side_len, -side_len, 0.f,   0.0f, 0.0f,       0.0f, 0.0f, 1.0f,
         -side_len,  side_len, 0.f,   0.0f, 1.0f,       0.0f, 0.0f, 1.0f;
-    return m;
+    return Mesh(verts.leftCols<3>(), faces, verts.middleCols<2>(3), verts.rightCols<3>());
 }
 
 Mesh Mesh::Cube(float side_len) {
-    Mesh m(36);
-    m.verts <<
+    PointsUVN verts(36, 8);
+    verts <<
         // positions                        // uv coords    // normals
         // back
         -side_len, -side_len, -side_len,    0.0f,  0.0f,    0.0f,  0.0f, -1.0f,
@@ -300,7 +333,183 @@ Mesh Mesh::Cube(float side_len) {
          side_len,  side_len,  side_len,    1.0f,  0.0f,    0.0f,  1.0f,  0.0f,
         -side_len,  side_len, -side_len,    0.0f,  1.0f,    0.0f,  1.0f,  0.0f,
         -side_len,  side_len,  side_len,    0.0f,  0.0f,    0.0f,  1.0f,  0.0f;
-    return m;
+    return Mesh(verts.leftCols<3>(), verts.middleCols<2>(3), verts.rightCols<3>());
+}
+
+// *** MeshGroup ***
+MeshGroup::MeshGroup(size_t num_instances,
+                     const Eigen::Ref<const Points>& pos,
+                     const Eigen::Ref<const Triangles>& tri_faces,
+                     const Eigen::Ref<const Points2D>& uv)
+    : num_instances(num_instances), num_verts(pos.rows()),
+      num_triangles(tri_faces.rows()), faces(tri_faces) {
+    this->pos.resize(num_instances * num_verts, this->pos.ColsAtCompileTime);
+    this->uv.setZero(num_verts, this->uv.ColsAtCompileTime);
+    norm.setZero(num_instances * num_verts, norm.ColsAtCompileTime);
+    pos_dirty.assign(num_instances, true);
+    norm_dirty.assign(num_instances, true);
+    VBO.fill((Index)-1);
+    transform.setIdentity();
+    if (!num_instances || !num_verts || !num_triangles ||
+        (uv.rows() && (size_t)uv.rows() != num_verts)) {
+        std::cerr << "Invalid meshview::MeshGroup construction: "
+            "num_instances, pos, tri_faces cannot be empty, "
+            "and pos, uv should have identical # rows\n";
+        return;
+    }
+    for (size_t i = 0; i < num_instances; ++i) {
+        verts_pos(i).noalias() = pos;
+    }
+    if (uv.rows())
+        this->uv.noalias() = uv;
+}
+
+MeshGroup::~MeshGroup() { free_bufs(); }
+
+void MeshGroup::draw(const Shader& shader, const Camera& camera) {
+    if (!enabled) return;
+    if (!~VAO) {
+        std::cerr << "ERROR: Please call meshview::MeshGroup::update() before MeshGroup::draw()\n";
+        return;
+    }
+
+    // Bind appropriate textures, once for all instances
+    shader_set_material(shader, textures, blank_tex_id, shininess);
+
+    // Set space transform matrices
+    shader_set_transform_matrices(shader, camera, transform);
+
+    // Draw all instances: same indices, offset by each instance's first vertex
+    glBindVertexArray(VAO);
+    glMultiDrawElementsBaseVertex(GL_TRIANGLES, draw_counts.data(), GL_UNSIGNED_INT,
+            draw_indices.data(), (GLsizei)num_instances, draw_base_verts.data());
+    glBindVertexArray(0);
+
+    // Always good practice to set everything back to defaults once configured.
+    glActiveTexture(GL_TEXTURE0);
+}
+
+MeshGroup& MeshGroup::estimate_normals() {
+    if (!normal_estimator.same_faces(faces, num_verts)) {
+        normal_estimator.set_faces(faces, num_verts);
+    }
+    for (size_t i = 0; i < num_instances; ++i) {
+        normal_estimator.estimate(pos.middleRows(i * num_verts, num_verts), verts_norm(i));
+    }
+    return *this;
+}
+
+MeshGroup& MeshGroup::set_shininess(float val) {
+    shininess = val;
+    return *this;
+}
+
+MeshGroup& MeshGroup::set_dynamic(bool val) {
+    dynamic = val;
+    return *this;
+}
+
+void MeshGroup::update(bool force_init) {
+    static const size_t SCALAR_SZ = sizeof(Scalar);
+
+    const size_t total_verts = num_instances * num_verts;
+    if (pos.rows() != (Eigen::Index)total_verts || norm.rows() != (Eigen::Index)total_verts ||
+        uv.rows() != (Eigen::Index)num_verts) {
+        std::cerr << "Invalid vertex buf size, expect " << total_verts << " rows\n";
+        return;
+    }
+    if (faces.size() != num_triangles * faces.ColsAtCompileTime) {
+        std::cerr << "Invalid indices size, expect " << num_triangles * faces.ColsAtCompileTime
+            << "\n";
+        return;
+    }
+
+    const size_t INDEX_SZ = faces.size() * sizeof(Index);
+
+    // Already initialized
+    const bool init = force_init || !~VAO;
+    load_textures(textures, init);
+    if (init) {
+        blank_tex_id = -1;
+
+        // create buffers/arrays
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(__STREAM_COUNT, VBO.data());
+        glGenBuffers(1, &EBO);
+
+        draw_counts.assign(num_instances, (int)faces.size());
+        draw_indices.assign(num_instances, nullptr);
+        draw_base_verts.resize(num_instances);
+        for (size_t i = 0; i < num_instances; ++i) {
+            draw_base_verts[i] = (int)(i * num_verts);
+        }
+    }
+
+    glBindVertexArray(VAO);
+    // load data into vertex buffers, one per attribute
+    const Scalar* stream_data[__STREAM_COUNT] = { pos.data(), uv.data(), norm.data() };
+    std::vector<char>* stream_dirty[__STREAM_COUNT] = { &pos_dirty, nullptr, &norm_dirty };
+    const int stream_cols[__STREAM_COUNT] = { 3, 2, 3 };
+    for (int i = 0; i < __STREAM_COUNT; ++i) {
+        if (!init && (i == STREAM_UV ? !uv_dirty :
+                    std::find(stream_dirty[i]->begin(), stream_dirty[i]->end(), true) ==
+                    stream_dirty[i]->end())) continue;
+        const size_t INST_SZ = num_verts * stream_cols[i] * SCALAR_SZ;
+        glBindBuffer(GL_ARRAY_BUFFER, VBO[i]);
+        if (init) {
+            glBufferData(GL_ARRAY_BUFFER, num_instances * INST_SZ,
+                    i == STREAM_UV ? nullptr : (GLvoid*) stream_data[i],
+                    dynamic && i != STREAM_UV ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
+            // set the vertex attribute pointer: 0 positions, 1 texture coords, 2 normals
+            glEnableVertexAttribArray(i);
+            glVertexAttribPointer(i, stream_cols[i], GL_FLOAT, GL_FALSE,
+                    stream_cols[i] * SCALAR_SZ, (GLvoid*)0);
+        }
+        if (i == STREAM_UV) {
+            // Shared uv: replicate for each instance
+            for (size_t j = 0; j < num_instances; ++j) {
+                glBufferSubData(GL_ARRAY_BUFFER, j * INST_SZ, INST_SZ, (GLvoid*) uv.data());
+            }
+            uv_dirty = false;
+            continue;
+        }
+        std::vector<char>& dirty = *stream_dirty[i];
+        if (init) {
+            std::fill(dirty.begin(), dirty.end(), false);
+            continue;
+        }
+        // Write each run of consecutive modified instances in place
+        for (size_t j = 0; j < num_instances;) {
+            if (!dirty[j]) {
+                ++j;
+                continue;
+            }
+            size_t end = j;
+            while (end < num_instances && dirty[end]) dirty[end++] = false;
+            glBufferSubData(GL_ARRAY_BUFFER, j * INST_SZ, (end - j) * INST_SZ,
+                    (GLvoid*) (stream_data[i] + j * num_verts * stream_cols[i]));
+            j = end;
+        }
+    }
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    if (init) {
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, INDEX_SZ, faces.data(), GL_STATIC_DRAW);
+        uploaded_faces = faces;
+    } else if (faces != uploaded_faces) {
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, INDEX_SZ, faces.data());
+        uploaded_faces = faces;
+    }
+    glBindVertexArray(0);
+}
+
+void MeshGroup::free_bufs() {
+    if (~VAO) glDeleteVertexArrays(1, &VAO);
+    for (Index vbo : VBO) {
+        if (~vbo) glDeleteBuffers(1, &vbo);
+    }
+    if (~EBO) glDeleteBuffers(1, &EBO);
+    if (~blank_tex_id) glDeleteTextures(1, &blank_tex_id);
 }
 
 // *** PointCloud ***
@@ -342,7 +551,8 @@ void PointCloud::update(bool force_init) {
     const size_t BUF_SZ = verts.size() * SCALAR_SZ;
 
     // Already initialized
-    if (force_init || !~VAO) {
+    const bool init = force_init || !~VAO;
+    if (init) {
         // Create buffers/arrays
         glGenVertexArrays(1, &VAO);
         glGenBuffers(1, &VBO);
@@ -350,6 +560,12 @@ void PointCloud::update(bool force_init) {
     glBindVertexArray(VAO);
     // load data into vertex buffers
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    if (!init) {
+        // Size is fixed (num_verts is const): overwrite in place
+        glBufferSubData(GL_ARRAY_BUFFER, 0, BUF_SZ, (GLvoid*) verts.data());
+        glBindVertexArray(0);
+        return;
+    }
     // A great thing about structs is that their memory layout is sequential for all its items.
     // The effect is that we can simply pass a pointer to the struct and it translates perfectly to a glm::vec3/2 array which
     // again translates to 3/2 floats which translates to a byte array.
@@ -404,34 +620,35 @@ PointCloud PointCloud::Line(const Eigen::Ref<const Vector3f>& a,
 }
 
 // *** Shared ***
-// Define identical function for both mesh, pointcloud classes
-#define BOTH_MESH_AND_POINTCLOUD(fbody) Mesh& Mesh::fbody PointCloud& PointCloud::fbody
+// Define identical function for mesh, mesh group, pointcloud classes
+#define ALL_MESH_TYPES(fbody) Mesh& Mesh::fbody MeshGroup& MeshGroup::fbody \
+    PointCloud& PointCloud::fbody
 
-BOTH_MESH_AND_POINTCLOUD(translate(const Eigen::Ref<const Vector3f>& vec) {
+ALL_MESH_TYPES(translate(const Eigen::Ref<const Vector3f>& vec) {
     (transform.topRightCorner<3,1>() += vec);
     return *this;
 })
 
-BOTH_MESH_AND_POINTCLOUD(rotate(const Eigen::Ref<const Matrix3f>& mat) {
+ALL_MESH_TYPES(rotate(const Eigen::Ref<const Matrix3f>& mat) {
     (transform.topLeftCorner<3, 3>() = mat * transform.topLeftCorner<3, 3>());
     return *this;
 })
 
-BOTH_MESH_AND_POINTCLOUD(scale(const Eigen::Ref<const Vector3f>& vec) {
+ALL_MESH_TYPES(scale(const Eigen::Ref<const Vector3f>& vec) {
     (transform.topLeftCorner<3, 3>().array().colwise() *= vec.array());
     return *this;
 })
 
-BOTH_MESH_AND_POINTCLOUD(scale(float val) {
+ALL_MESH_TYPES(scale(float val) {
     (transform.topLeftCorner<3, 3>().array() *= val);
     return *this;
 })
 
-BOTH_MESH_AND_POINTCLOUD(set_transform(const Eigen::Ref<const Matrix4f>& mat) {
+ALL_MESH_TYPES(set_transform(const Eigen::Ref<const Matrix4f>& mat) {
     transform = mat;
     return *this;
 })
 
-BOTH_MESH_AND_POINTCLOUD(enable(bool val) { enabled = val; return *this; })
+ALL_MESH_TYPES(enable(bool val) { enabled = val; return *this; })
 
 }  // namespace meshview
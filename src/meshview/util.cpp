@@ -1,6 +1,11 @@
 #include "meshview/util.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <fstream>
+#include <thread>
+#include <vector>
 #include <Eigen/Geometry>
 
 #include "meshview/common.hpp"
@@ -8,6 +13,39 @@
 namespace meshview {
 namespace util {
 
+namespace {
+
+// Below this many items, work is done on the calling thread
+// (spawning threads costs more than a body-sized mesh takes)
+constexpr size_t PARALLEL_MIN_ITEMS = 1 << 15;
+
+// Run f(begin, end) over [0, n) split into contiguous chunks,
+// one per hardware thread when n is large enough
+template<class Func>
+void parallel_ranges(size_t n, Func f) {
+    if (n < 2 * PARALLEL_MIN_ITEMS) {
+        f(size_t(0), n);
+        return;
+    }
+    static const size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+    const size_t n_threads = std::min(max_threads, n / PARALLEL_MIN_ITEMS);
+    if (n_threads <= 1) {
+        f(size_t(0), n);
+        return;
+    }
+    std::vector<std::thread> threads;
+    threads.reserve(n_threads - 1);
+    const size_t chunk = (n + n_threads - 1) / n_threads;
+    for (size_t i = 1; i < n_threads; ++i) {
+        const size_t begin = std::min(n, i * chunk), end = std::min(n, begin + chunk);
+        threads.emplace_back(f, begin, end);
+    }
+    f(size_t(0), std::min(n, chunk));
+    for (auto& t : threads) t.join();
+}
+
+}  // namespace
+
 Matrix4f persp(float xscale, float yscale, float z_near, float z_far) {
     Matrix4f m;
     m << xscale, 0.f, 0.f, 0.f,
@@ -71,5 +109,85 @@ void estimate_normals(const Eigen::Ref<const Points>& verts,
     out.array().colwise() /= face_cnt.array();
 }
 
+// *** NormalEstimator ***
+NormalEstimator::NormalEstimator(const Eigen::Ref<const Triangles>& faces,
+                                 size_t num_verts) {
+    set_faces(faces, num_verts);
+}
+
+void NormalEstimator::set_faces(const Eigen::Ref<const Triangles>& faces,
+                                size_t num_verts) {
+    _faces = faces;
+    _face_normals.resize(faces.rows(), 3);
+
+    // Counting sort of (vertex, face) pairs by vertex
+    _vert_face_begin.assign(num_verts + 1, 0);
+    for (Eigen::Index i = 0; i < _faces.size(); ++i) {
+        ++_vert_face_begin[_faces.data()[i] + 1];
+    }
+    for (size_t i = 0; i < num_verts; ++i) {
+        _vert_face_begin[i + 1] += _vert_face_begin[i];
+    }
+    _vert_faces.resize(_faces.size());
+    std::vector<Index> pos(_vert_face_begin.begin(), _vert_face_begin.end() - 1);
+    for (Eigen::Index i = 0; i < _faces.rows(); ++i) {
+        for (int j = 0; j < 3; ++j) {
+            _vert_faces[pos[_faces(i, j)]++] = (Index)i;
+        }
+    }
+}
+
+bool NormalEstimator::same_faces(const Eigen::Ref<const Triangles>& faces,
+                                 size_t num_verts) const {
+    return num_verts == this->num_verts() && faces.rows() == _faces.rows() &&
+        (faces.rows() == 0 || std::memcmp(faces.data(), _faces.data(),
+                                          _faces.size() * sizeof(Index)) == 0);
+}
+
+void NormalEstimator::estimate(const Eigen::Ref<const Points>& verts,
+                               Eigen::Ref<Points> out) {
+    // Face normals, in blocks so the cross products vectorize
+    // after the (indexed) vertex loads
+    const Index* faces = _faces.data();
+    Scalar* face_normals = _face_normals.data();
+    parallel_ranges((size_t)_faces.rows(), [&](size_t begin, size_t end) {
+        constexpr size_t BLOCK = 64;
+        Scalar e1[3][BLOCK], e2[3][BLOCK];
+        for (size_t b = begin; b < end; b += BLOCK) {
+            const size_t cnt = std::min(BLOCK, end - b);
+            for (size_t k = 0; k < cnt; ++k) {
+                const Index* f = faces + 3 * (b + k);
+                for (int c = 0; c < 3; ++c) {
+                    const Scalar p0 = verts(f[0], c);
+                    e1[c][k] = verts(f[1], c) - p0;
+                    e2[c][k] = verts(f[2], c) - p0;
+                }
+            }
+            Scalar* n = face_normals + 3 * b;
+            for (size_t k = 0; k < cnt; ++k) {
+                n[3 * k]     = e1[1][k] * e2[2][k] - e1[2][k] * e2[1][k];
+                n[3 * k + 1] = e1[2][k] * e2[0][k] - e1[0][k] * e2[2][k];
+                n[3 * k + 2] = e1[0][k] * e2[1][k] - e1[1][k] * e2[0][k];
+            }
+        }
+    });
+
+    // Gather per vertex and normalize
+    parallel_ranges(num_verts(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            Scalar x = 0.f, y = 0.f, z = 0.f;
+            for (Index j = _vert_face_begin[i]; j < _vert_face_begin[i + 1]; ++j) {
+                const Scalar* n = face_normals + 3 * _vert_faces[j];
+                x += n[0]; y += n[1]; z += n[2];
+            }
+            const Scalar norm_sq = x * x + y * y + z * z;
+            const Scalar inv_norm = norm_sq > 0.f ? 1.f / std::sqrt(norm_sq) : 0.f;
+            out(i, 0) = x * inv_norm;
+            out(i, 1) = y * inv_norm;
+            out(i, 2) = z * inv_norm;
+        }
+    });
+}
+
 }  // namespace util
 }  // namespace meshview
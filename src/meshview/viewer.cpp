@@ -272,6 +272,7 @@ void Viewer::show() {
 
     // Ask to re-create the buffers + textures in meshes/pointclouds
     for (auto& mesh : meshes) mesh.update(true);
+    for (auto& mesh_group : mesh_groups) mesh_group.update(true);
     for (auto& pc : point_clouds) pc.update(true);
 
     shader_mesh.use();
@@ -301,6 +302,9 @@ void Viewer::show() {
         for (auto& mesh : meshes) {
             mesh.draw(shader_mesh, camera);
         }
+        for (auto& mesh_group : mesh_groups) {
+            mesh_group.draw(shader_mesh, camera);
+        }
 
         if (on_loop) on_loop();
 
@@ -334,6 +338,9 @@ void Viewer::show() {
     for (auto& mesh : meshes) {
         mesh.free_bufs(); // Delete any existing buffers to prevent memory leak
     }
+    for (auto& mesh_group : mesh_groups) {
+        mesh_group.free_bufs();
+    }
 
 #ifdef MESHVIEW_IMGUI
     ImGui_ImplOpenGL3_Shutdown();
@@ -353,6 +360,15 @@ Mesh& Viewer::add(const Mesh& mesh) {
     return meshes.back();
 }
 
+MeshGroup& Viewer::add(MeshGroup&& mesh_group) {
+    mesh_groups.push_back(mesh_group);
+    return mesh_groups.back();
+}
+MeshGroup& Viewer::add(const MeshGroup& mesh_group) {
+    mesh_groups.push_back(mesh_group);
+    return mesh_groups.back();
+}
+
 PointCloud& Viewer::add(PointCloud&& point_cloud) {
     point_clouds.push_back(point_cloud);
     return point_clouds.back();
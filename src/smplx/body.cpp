@@ -1,9 +1,11 @@
+#include <algorithm>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
 
 #include "smplx/smplx.hpp"
 #include "smplx/util.hpp"
+#include "smplx/internal/lbs.hpp"
 
 namespace smplx {
 
@@ -13,6 +15,11 @@ Body<ModelConfig>::Body(const Model<ModelConfig>& model, bool set_zero)
     if (set_zero) this->set_zero();
     // Point cloud after applying shape keys but before lbs (num points, 3)
     _verts_shaped.resize(model.n_verts(), 3);
+    _verts_shape_only.resize(model.n_verts(), 3);
+    _verts_dirty.resize(model.n_verts());
+
+    // Shape params + pose blend shape params
+    _blendshape_params.resize(model.n_blend_shapes());
 
     // Joints after applying shape keys but before lbs (num joints, 3)
     _joints_shaped.resize(model.n_joints(), 3);
@@ -20,9 +27,13 @@ Body<ModelConfig>::Body(const Model<ModelConfig>& model, bool set_zero)
     // Final deformed point cloud
     _verts.resize(model.n_verts(), 3);
 
+    // Final joint positions
+    _joints.resize(model.n_joints(), 3);
+
     // Affine joint transformation, as 3x4 matrices stacked horizontally (bottom
     // row omitted) NOTE: col major
     _joint_transforms.resize(model.n_joints(), 12);
+    _local_transforms.resize(model.n_joints(), 12);
 #ifdef SMPLX_CUDA_ENABLED
     _cuda_load();
 #endif
@@ -51,128 +62,294 @@ const Points& Body<ModelConfig>::joints() const {
 template<class ModelConfig>
 void Body<ModelConfig>::update(bool force_cpu, bool enable_pose_blendshapes) {
     // _SMPLX_BEGIN_PROFILE;
-    // Will store full pose params (angle-axis), including hand
-    Vector full_pose(3 * model.n_joints());
-
-    // Shape params +/ linear joint transformations as flattened 3x3 rotation
-    // matrices rowmajor, only for blend shapes
-    Vector blendshape_params(model.n_blend_shapes());
-
-    using AffineTransformMap =
-        Eigen::Map<Eigen::Matrix<Scalar, 3, 4, Eigen::RowMajor> >;
-    using RotationMap =
-        Eigen::Map<Eigen::Matrix<Scalar, 3, 3, Eigen::RowMajor> >;
-
-    // Copy body pose onto full pose
-    full_pose.head(3 * model.n_explicit_joints()).noalias() = pose();
-    if (model.n_hand_pca_joints() > 0) {
-        // Use hand PCA weights to fill in hand pose within full pose
-        full_pose.segment(3 * model.n_explicit_joints(), 3 * model.n_hand_pca_joints())
-            .noalias() = model.hand_mean_l + model.hand_comps_l * hand_pca_l();
-        full_pose.tail(3 * model.n_hand_pca_joints()).noalias() =
-            model.hand_mean_r + model.hand_comps_r * hand_pca_r();
-    }
-
-    // Copy shape params to blendshape params
-    blendshape_params.head<ModelConfig::n_shape_blends()>() = shape();
-
-    // Convert angle-axis to rotation matrix using rodrigues
-    AffineTransformMap(_joint_transforms.topRows<1>().data())
-        .template leftCols<3>().noalias() =
-        util::rodrigues<float>(full_pose.head<3>());
-    for (size_t i = 1; i < model.n_joints(); ++i) {
-        AffineTransformMap joint_trans(_joint_transforms.row(i).data());
-        joint_trans.template leftCols<3>().noalias() =
-            util::rodrigues<float>(full_pose.segment<3>(3 * i));
-        RotationMap mp(blendshape_params.data() +  9 * i + (model.n_shape_blends() - 9));
-        mp.noalias() = joint_trans.template leftCols<3>();
-        mp.diagonal().array() -= 1.f;
-    }
+    _begin_update();
 
 #ifdef SMPLX_CUDA_ENABLED
     _last_update_used_gpu = !force_cpu;
     if (!force_cpu) {
-        _cuda_update(blendshape_params.data(),
+        _incremental_valid = false;
+        _cuda_update(_blendshape_params.data(),
                      _joint_transforms.data(),
                      enable_pose_blendshapes);
         return;
     }
 #endif
 
+    _update_cpu(enable_pose_blendshapes, _verts, Eigen::Map<Points>(nullptr, 0, 3));
+    _incremental_valid = true;
+}
+
+template<class ModelConfig>
+void Body<ModelConfig>::update_with_normals(Eigen::Ref<Points> out_verts,
+        Eigen::Ref<Points> out_normals, bool enable_pose_blendshapes) {
+    _SMPLX_ASSERT_EQ(size_t(out_verts.rows()), model.n_verts());
+    _SMPLX_ASSERT_EQ(size_t(out_normals.rows()), model.n_verts());
+    _begin_update();
+#ifdef SMPLX_CUDA_ENABLED
+    _last_update_used_gpu = false;
+#endif
+    _update_cpu(enable_pose_blendshapes, out_verts, out_normals);
+    // verts() was not updated, so update_incremental can't build on this
+    _incremental_valid = false;
+}
+
+template<class ModelConfig>
+void Body<ModelConfig>::update_with_normals(Eigen::Ref<PointsUVN> out,
+        bool enable_pose_blendshapes) {
+    update_with_normals(out.leftCols<3>(), out.rightCols<3>(), enable_pose_blendshapes);
+}
+
+template<class ModelConfig>
+void Body<ModelConfig>::_begin_update() {
+    // Copy shape params to blendshape params
+    _blendshape_params.head<ModelConfig::n_shape_blends()>() = shape();
+
+    // Convert angle-axis to rotation matrix using rodrigues
+    internal::params_to_local_transforms<ModelConfig>(model, params,
+            _joint_transforms,
+            _blendshape_params.data() + model.n_shape_blends());
+
+    _check_shape_cache();
+}
+
+template<class ModelConfig>
+void Body<ModelConfig>::_update_cpu(bool enable_pose_blendshapes,
+        Eigen::Ref<Points> out_verts, Eigen::Ref<Points> out_normals) {
     // _SMPLX_PROFILE(preproc);
-    // Apply blend shapes
-    {
-        Eigen::Map<Eigen::Matrix<Scalar, Eigen::Dynamic, 1> > verts_shaped_flat(
-            _verts_shaped.data(), model.n_verts() * 3);
-        Eigen::Map<const Eigen::Matrix<Scalar, Eigen::Dynamic, 1> >
-            verts_init_flat(model.verts.data(), model.n_verts() * 3);
-        if (enable_pose_blendshapes) {
-            // HORRIBLY SLOW, like 95% of the time is spent here yikes
-            // Add shape blend shapes
-            verts_shaped_flat.noalias() = verts_init_flat +
-                model.blend_shapes * blendshape_params;
-        } else {
-            // Add shape blend shapes
-            verts_shaped_flat.noalias() = verts_init_flat +
-                    model.blend_shapes.template leftCols<ModelConfig::n_shape_blends()>() *
-                    blendshape_params.head<ModelConfig::n_shape_blends()>();
-        }
+    if (!_shape_cache_valid) {
+        // Apply shape blend shapes and joint regressor; only done when the
+        // shape changes
+        internal::shape_blend_shapes<ModelConfig>(model,
+                Eigen::Map<const MatrixColMajor>(_blendshape_params.data(),
+                    model.n_shape_blends(), 1),
+                Eigen::Map<MatrixColMajor>(_verts_shape_only.data(),
+                    3 * model.n_verts(), 1));
+        _joints_shaped.noalias() = model.joint_reg * _verts_shape_only;
+        _shape_cache_valid = true;
+        _normals_shape_only_valid = false;
+    }
+    const bool with_normals = out_normals.rows() > 0;
+    if (with_normals && !_normals_shape_only_valid) {
+        _normals_shape_only.resize(model.n_verts(), 3);
+        internal::vertex_normals(_verts_shape_only, model.faces, _normals_shape_only);
+        _normals_shape_only_valid = true;
     }
-    // _SMPLX_PROFILE(blendshape);
 
-    // Apply joint regressor
-    _joints_shaped = model.joint_reg * _verts_shaped;
+    // Apply pose blend shapes
+    // HORRIBLY SLOW with full pose blend shapes, like 95% of the time is spent here;
+    // see Model::compress_pose_blendshapes, Model::set_blend_shapes_layout
+    const bool fused_lbs = enable_pose_blendshapes && model.pose_blend_rank() == 0 &&
+        model.blend_shapes_tiled.size();
+    if (fused_lbs) {
+        // Tiled blend shapes: applied together with LBS below
+    } else if (enable_pose_blendshapes) {
+        internal::pose_blend_shapes<ModelConfig>(model,
+                Eigen::Map<const MatrixColMajor>(
+                    _blendshape_params.data() + model.n_shape_blends(),
+                    model.n_pose_blends(), 1),
+                Eigen::Map<const MatrixColMajor>(_verts_shape_only.data(),
+                    3 * model.n_verts(), 1),
+                Eigen::Map<MatrixColMajor>(_verts_shaped.data(),
+                    3 * model.n_verts(), 1),
+                _pose_latent);
+    } else {
+        _verts_shaped.noalias() = _verts_shape_only;
+    }
+    // _SMPLX_PROFILE(blendshape);
 
-    // local_to_global<ModelConfig>(trans(), _joints_shaped, _joints, _joint_transforms);
+    _local_transforms.noalias() = _joint_transforms;
     _local_to_global();
-	// _SMPLX_PROFILE(localglobal);
+    // _SMPLX_PROFILE(localglobal);
 
     // * LBS *
-    // Construct a transform for each vertex
-    Eigen::Matrix<Scalar, Eigen::Dynamic, 12, Eigen::RowMajor> vert_transforms =
-        model.weights * _joint_transforms;
-    // _SMPLX_PROFILE(lbs weight computation);
-
-    // Apply affine transform to each vertex and store to output
-    for (size_t i = 0; i < model.n_verts(); ++i) {
-        AffineTransformMap transform(vert_transforms.row(i).data());
-        _verts.row(i) =
-            _verts_shaped.row(i).homogeneous() * transform.transpose();
+    auto skin = [&](auto skin_range) {
+        if (fused_lbs) {
+            internal::pose_blend_shapes_lbs_tiled<ModelConfig>(model,
+                    _blendshape_params.data() + model.n_shape_blends(),
+                    _verts_shape_only, _verts_shaped, skin_range);
+        } else {
+            internal::parallel_for(0, ModelConfig::n_verts(),
+                    internal::verts_grain(internal::lbs_work_per_vert(model)),
+                    skin_range);
+        }
+    };
+    if (with_normals) {
+        skin([&](size_t begin, size_t end) {
+            internal::lbs_normals_range<ModelConfig>(model, _joint_transforms,
+                    _verts_shaped, _normals_shape_only, out_verts, out_normals,
+                    begin, end);
+        });
+    } else {
+        skin([&](size_t begin, size_t end) {
+            internal::lbs_range<ModelConfig>(model, _joint_transforms, _verts_shaped,
+                    out_verts, begin, end);
+        });
     }
-    // _SMPLX_PROFILE(lbs point transform);
+    // _SMPLX_PROFILE(lbs);
+
+    _last_enable_pose_blendshapes = enable_pose_blendshapes;
+    _last_pose_blend_rank = model.pose_blend_rank();
+    _last_trans.noalias() = trans();
 }
 
 template<class ModelConfig>
-void Body<ModelConfig>::_local_to_global() {
-    _joints.resize(ModelConfig::n_joints(), 3);
-    using AffineTransformMap = Eigen::Map<Eigen::Matrix<Scalar, 3, 4, Eigen::RowMajor> >;
-    // Handle root joint transforms
-    AffineTransformMap root_transform(_joint_transforms.topRows<1>().data());
-    root_transform.template rightCols<1>().noalias() =
-        _joints_shaped.topRows<1>().transpose() + trans();
-    _joints.template topRows<1>().noalias() = root_transform.template rightCols<1>().transpose();
-
-    // Complete the affine transforms for all other joint by adding translation
-    // components and composing with parent
-    for (int i = 1; i < ModelConfig::n_joints(); ++i) {
-        AffineTransformMap transform(_joint_transforms.row(i).data());
-        const auto p = ModelConfig::parent[i];
-        // Set relative translation
-        transform.template rightCols<1>().noalias() =
-            (_joints_shaped.row(i) - _joints_shaped.row(p)).transpose();
-        // Compose rotation with parent
-        util::mul_affine<float, Eigen::RowMajor>(
-            AffineTransformMap(_joint_transforms.row(p).data()), transform);
-        // Grab the joint position in case the user wants it
-        _joints.row(i).noalias() = transform.template rightCols<1>().transpose();
+void Body<ModelConfig>::update_incremental(bool enable_pose_blendshapes) {
+    constexpr size_t n_joints = ModelConfig::n_joints();
+    constexpr size_t n_shape_blends = ModelConfig::n_shape_blends();
+    constexpr size_t n_pose_blends = ModelConfig::n_pose_blends();
+    static constexpr auto sched = ModelConfig::kinematic_schedule();
+
+    _check_shape_cache();
+    if (!_incremental_valid || !_shape_cache_valid ||
+            enable_pose_blendshapes != _last_enable_pose_blendshapes ||
+            model.pose_blend_rank() != _last_pose_blend_rank) {
+        update(true, enable_pose_blendshapes);
+        return;
+    }
+
+    // New local rotations and pose blend shape params
+    Eigen::Matrix<Scalar, n_joints, 12, Eigen::RowMajor> local_transforms;
+    Eigen::Matrix<Scalar, n_pose_blends, 1> pose_blend_params;
+    internal::params_to_local_transforms<ModelConfig>(model, params,
+            local_transforms, pose_blend_params.data());
+
+    // Find joints whose local rotation changed
+    bool changed[n_joints], any_changed = false;
+    for (size_t i = 0; i < n_joints; ++i) {
+        changed[i] = internal::AffineTransformMap(local_transforms.row(i).data())
+            .template leftCols<3>() !=
+            internal::AffineTransformMap(_local_transforms.row(i).data())
+            .template leftCols<3>();
+        any_changed |= changed[i];
+    }
+    if (trans() != _last_trans) changed[0] = any_changed = true;
+    if (!any_changed) return;
+
+    std::fill(_verts_dirty.begin(), _verts_dirty.end(), 0);
+
+    // Apply the change in pose blend shapes of changed joints only
+    if (enable_pose_blendshapes) {
+        auto old_pose_blend_params = _blendshape_params.tail<n_pose_blends>();
+        const Eigen::Matrix<Scalar, n_pose_blends, 1> pose_delta =
+            pose_blend_params - old_pose_blend_params;
+        const size_t rank = model.pose_blend_rank();
+        if (rank > 0) {
+            _pose_latent.setZero(rank, 1);
+            for (size_t i = 1; i < n_joints; ++i) {
+                if (!changed[i]) continue;
+                _pose_latent.noalias() +=
+                    model.pose_blend_coeffs.middleCols(9 * (i - 1), 9) *
+                    pose_delta.template segment<9>(9 * (i - 1));
+            }
+        }
+        size_t n_changed = 0;
+        for (size_t i = 1; i < n_joints; ++i) n_changed += changed[i];
+        internal::parallel_for(0, ModelConfig::n_verts(),
+                internal::verts_grain(3 * (rank > 0 ? rank : 9 * n_changed)),
+            [&](size_t begin, size_t end) {
+                // Vertex deltas are computed in blocks, in a fixed-capacity buffer
+                constexpr size_t block_size = 256;
+                Eigen::Matrix<Scalar, Eigen::Dynamic, 1, 0, 3 * block_size, 1> verts_delta;
+                for (size_t block = begin; block < end; block += block_size) {
+                    const size_t block_end = std::min(block + block_size, end);
+                    const size_t n_rows = 3 * (block_end - block);
+                    if (rank > 0) {
+                        verts_delta.noalias() =
+                            model.pose_blend_basis.middleRows(3 * block, n_rows) *
+                            _pose_latent;
+                    } else {
+                        verts_delta.setZero(n_rows);
+                        for (size_t i = 1; i < n_joints; ++i) {
+                            if (!changed[i]) continue;
+                            if (model.blend_shapes_precision() != Precision::fp32) {
+                                internal::reduced_gemm_add(
+                                        model.blend_shapes_half.data(),
+                                        3 * model.n_verts(),
+                                        model.blend_shapes_precision(), 3 * block,
+                                        n_shape_blends + 9 * (i - 1),
+                                        Eigen::Map<const MatrixColMajor>(
+                                            pose_delta.data() + 9 * (i - 1), 9, 1),
+                                        Eigen::Map<MatrixColMajor>(
+                                            verts_delta.data(), n_rows, 1));
+                                continue;
+                            }
+                            verts_delta.noalias() += model.blend_shapes.block(3 * block,
+                                    n_shape_blends + 9 * (i - 1), n_rows, 9) *
+                                pose_delta.template segment<9>(9 * (i - 1));
+                        }
+                    }
+                    for (size_t v = block; v < block_end; ++v) {
+                        const auto vert_delta =
+                            verts_delta.template segment<3>(3 * (v - block));
+                        if (vert_delta.isZero(0.f)) continue;
+                        _verts_shaped.row(v).noalias() += vert_delta.transpose();
+                        _verts_dirty[v] = 1;
+                    }
+                }
+            });
+        old_pose_blend_params.noalias() = pose_blend_params;
     }
 
-    for (int i = 0; i < ModelConfig::n_joints(); ++i) {
-        AffineTransformMap transform(_joint_transforms.row(i).data());
+    // Recompute global transforms in the subtrees of changed joints,
+    // in depth-first (topological) order
+    bool affected[n_joints] = {};
+    for (size_t i = 0; i < n_joints; ++i) {
+        if (!changed[i]) continue;
+        for (size_t k = sched.subtree_begin[i]; k < sched.subtree_end[i]; ++k) {
+            affected[sched.dfs_order[k]] = true;
+        }
+    }
+    for (size_t k = 0; k < n_joints; ++k) {
+        const size_t i = sched.dfs_order[k];
+        if (!affected[i]) continue;
+        internal::AffineTransformMap transform(_joint_transforms.row(i).data());
+        const auto local_rot = internal::AffineTransformMap(
+                local_transforms.row(i).data()).template leftCols<3>();
+        if (i == 0) {
+            transform.template leftCols<3>().noalias() = local_rot;
+            _joints.row(0).noalias() = _joints_shaped.row(0) + trans().transpose();
+        } else {
+            const size_t p = ModelConfig::parent[i];
+            const auto parent_rot = internal::AffineTransformMap(
+                    _joint_transforms.row(p).data()).template leftCols<3>();
+            transform.template leftCols<3>().noalias() = parent_rot * local_rot;
+            _joints.row(i).noalias() = _joints.row(p) +
+                (_joints_shaped.row(i) - _joints_shaped.row(p)) * parent_rot.transpose();
+        }
         // Normalize the translation to global
-        transform.template rightCols<1>().noalias() -=
+        transform.template rightCols<1>().noalias() = _joints.row(i).transpose() -
             transform.template leftCols<3>() * _joints_shaped.row(i).transpose();
+
+        // Vertices influenced by this joint must be re-skinned
+        for (auto it = model.weights.outerIndexPtr()[i];
+                it < model.weights.outerIndexPtr()[i + 1]; ++it) {
+            _verts_dirty[model.weights.innerIndexPtr()[it]] = 1;
+        }
     }
+    _local_transforms.noalias() = local_transforms;
+    _last_trans.noalias() = trans();
+
+    // * LBS *, only on dirty vertices
+    internal::lbs<ModelConfig>(model, _joint_transforms, _verts_shaped, _verts,
+            _verts_dirty.data());
+}
+
+template<class ModelConfig>
+void Body<ModelConfig>::_check_shape_cache() {
+    if (_cached_model_version == model.version() && _cached_shape == shape())
+        return;
+    _cached_shape.noalias() = shape();
+    _cached_model_version = model.version();
+    _shape_cache_valid = false;
+#ifdef SMPLX_CUDA_ENABLED
+    _shape_cache_valid_gpu = false;
+#endif
+}
+
+template<class ModelConfig>
+void Body<ModelConfig>::_local_to_global() {
+    internal::local_to_global<ModelConfig>(trans(), _joints_shaped,
+            _joint_transforms, _joints);
 }
 
 template<class ModelConfig>
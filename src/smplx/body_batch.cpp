@@ -0,0 +1,89 @@
+#include "smplx/smplx.hpp"
+#include "smplx/util.hpp"
+#include "smplx/internal/lbs.hpp"
+#include "smplx/internal/thread_pool.hpp"
+
+namespace smplx {
+
+template<class ModelConfig>
+BodyBatch<ModelConfig>::BodyBatch(const Model<ModelConfig>& model,
+        size_t batch_size, bool set_zero)
+    : model(model), params(batch_size, model.n_params()) {
+    if (set_zero) this->set_zero();
+}
+
+template<class ModelConfig>
+void BodyBatch<ModelConfig>::resize(size_t batch_size) {
+    const size_t old_size = this->batch_size();
+    params.conservativeResize(batch_size, Eigen::NoChange);
+    if (batch_size > old_size) params.bottomRows(batch_size - old_size).setZero();
+}
+
+template<class ModelConfig>
+void BodyBatch<ModelConfig>::update(bool enable_pose_blendshapes) {
+    const size_t n_batch = batch_size();
+    constexpr size_t n_shape_blends = ModelConfig::n_shape_blends();
+    _blendshape_params.resize(model.n_blend_shapes(), n_batch);
+    _verts_shaped.resize(3 * model.n_verts(), n_batch);
+    _verts.resize(n_batch, 3 * model.n_verts());
+    _joints.resize(n_batch, 3 * model.n_joints());
+    _joints_shaped.resize(n_batch * model.n_joints(), 3);
+    _joint_transforms.resize(n_batch * model.n_joints(), 12);
+
+    // Shape params, local joint rotations and pose blend shape params for each body
+    _blendshape_params.topRows<n_shape_blends>().noalias() =
+        params.rightCols<n_shape_blends>().transpose();
+    for (size_t i = 0; i < n_batch; ++i) {
+        internal::params_to_local_transforms<ModelConfig>(model,
+                params.row(i).transpose(),
+                _joint_transforms.middleRows(i * model.n_joints(), model.n_joints()),
+                _blendshape_params.col(i).data() + n_shape_blends);
+    }
+
+    // Apply shape blend shapes to all bodies at once (GEMM)
+    internal::shape_blend_shapes<ModelConfig>(model,
+            _blendshape_params.topRows<n_shape_blends>(), _verts_shaped);
+
+    // Joint regressor, on vertices with only shape applied
+    internal::parallel_for(0, n_batch, 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            Eigen::Map<const Points> verts_shaped(_verts_shaped.col(i).data(),
+                    model.n_verts(), 3);
+            _joints_shaped.middleRows(i * model.n_joints(), model.n_joints())
+                .noalias() = model.joint_reg * verts_shaped;
+        }
+    });
+
+    // Add pose blend shapes to all bodies at once (GEMM)
+    if (enable_pose_blendshapes) {
+        internal::pose_blend_shapes<ModelConfig>(model,
+                _blendshape_params.bottomRows<ModelConfig::n_pose_blends()>(),
+                _verts_shaped, _verts_shaped, _pose_latent);
+    }
+
+    // Kinematics and LBS, multithreaded over bodies
+    internal::parallel_for(0, n_batch, 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            Eigen::Map<const Points> verts_shaped(_verts_shaped.col(i).data(),
+                    model.n_verts(), 3);
+            Eigen::Map<Points> verts_out(_verts.row(i).data(), model.n_verts(), 3);
+            Eigen::Map<Points> joints_out(_joints.row(i).data(), model.n_joints(), 3);
+            auto joint_transforms = _joint_transforms.middleRows(
+                    i * model.n_joints(), model.n_joints());
+
+            internal::local_to_global<ModelConfig>(
+                    params.row(i).template head<3>().transpose(),
+                    _joints_shaped.middleRows(i * model.n_joints(), model.n_joints()),
+                    joint_transforms, joints_out);
+            internal::lbs<ModelConfig>(model, joint_transforms, verts_shaped, verts_out);
+        }
+    });
+}
+
+// Instantiation
+template class BodyBatch<model_config::SMPL>;
+template class BodyBatch<model_config::SMPLH>;
+template class BodyBatch<model_config::SMPLX>;
+template class BodyBatch<model_config::SMPLXpca>;
+
+}  // namespace smplx
@@ -137,6 +137,8 @@ __host__ void Body<ModelConfig>::_cuda_load() {
                model.n_joints() * 12 * sizeof(float)));
     cudaCheck(cudaMalloc((void**)&device.verts_shaped,
                          model.n_verts() * 3 * sizeof(float)));
+    cudaCheck(cudaMalloc((void**)&device.verts_shape_only,
+                         model.n_verts() * 3 * sizeof(float)));
     cudaCheck(cudaMalloc((void**)&device.joints_shaped,
                          model.n_joints() * 3 * sizeof(float)));
 }
@@ -146,6 +148,7 @@ __host__ void Body<ModelConfig>::_cuda_free() {
     if (device.blendshape_params) cudaFree(device.blendshape_params);
     if (device.joint_transforms) cudaFree(device.joint_transforms);
     if (device.verts_shaped) cudaFree(device.verts_shaped);
+    if (device.verts_shape_only) cudaFree(device.verts_shape_only);
     if (device.joints_shaped) cudaFree(device.joints_shaped);
 }
 template<class ModelConfig>
@@ -174,32 +177,37 @@ SMPLX_HOST void Body<ModelConfig>::_cuda_update(
     cudaCheck(cudaMemcpyAsync(device.joint_transforms, h_joint_transforms,
                 model.n_joints() * 12 * sizeof(float),
                cudaMemcpyHostToDevice));
-    // Blend shapes
-    if (enable_pose_blendshapes) {
-        cudaMemcpyAsync(device.verts_shaped, model.device.verts,
-                   model.n_verts() * 3 * sizeof(float), cudaMemcpyDeviceToDevice);
-        cuda_util::mmv_block<float, true>(model.device.blend_shapes,
-               device.blendshape_params, device.verts_shaped, model.n_verts() * 3,
-               model.n_blend_shapes());
-    } else {
-        cudaCheck(cudaMemcpyAsync(device.verts_shaped, model.device.verts,
+    if (!_shape_cache_valid_gpu) {
+        // Shape blend shapes
+        cudaCheck(cudaMemcpyAsync(device.verts_shape_only, model.device.verts,
                    model.n_verts() * 3 * sizeof(float), cudaMemcpyDeviceToDevice));
         cuda_util::mmv_block<float, true>(model.device.blend_shapes,
-                device.blendshape_params, device.verts_shaped, model.n_verts() * 3,
+                device.blendshape_params, device.verts_shape_only, model.n_verts() * 3,
                 model.n_shape_blends());
+
+        // Joint regressor TODO optimize sparse matrix multiplication, maybe use ELL format
+        dim3 jr_blocks(3, model.n_joints());
+        device::joint_regressor<<<1, jr_blocks>>>(
+            device.verts_shape_only, model.device.joint_reg.values, model.device.joint_reg.inner,
+            model.device.joint_reg.outer, device.joints_shaped);
+        cudaMemcpy(_joints_shaped.data(), device.joints_shaped, model.n_joints() * 3 * sizeof(float),
+                   cudaMemcpyDeviceToHost);
+        _shape_cache_valid_gpu = true;
     }
 
-    // Joint regressor TODO optimize sparse matrix multiplication, maybe use ELL format
-    dim3 jr_blocks(3, model.n_joints());
-    device::joint_regressor<<<1, jr_blocks>>>(
-        device.verts_shaped, model.device.joint_reg.values, model.device.joint_reg.inner,
-        model.device.joint_reg.outer, device.joints_shaped);
+    // Pose blend shapes
+    cudaCheck(cudaMemcpyAsync(device.verts_shaped, device.verts_shape_only,
+               model.n_verts() * 3 * sizeof(float), cudaMemcpyDeviceToDevice));
+    if (enable_pose_blendshapes) {
+        cuda_util::mmv_block<float, true>(
+               model.device.blend_shapes + model.n_shape_blends() * model.n_verts() * 3,
+               device.blendshape_params + model.n_shape_blends(),
+               device.verts_shaped, model.n_verts() * 3, model.n_pose_blends());
+    }
 
     // Compute global joint transforms, this part can't be parallized and
     // is horribly slow on GPU; we do it on CPU instead
     // Actually, this is pretty bad too, TODO try implementing on GPU again
-    cudaMemcpy(_joints_shaped.data(), device.joints_shaped, model.n_joints() * 3 * sizeof(float),
-               cudaMemcpyDeviceToHost);
     _local_to_global();
     cudaMemcpyAsync(device.joint_transforms, _joint_transforms.data(),
             _joint_transforms.size() * sizeof(float), cudaMemcpyHostToDevice);
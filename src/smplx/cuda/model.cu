@@ -2,6 +2,7 @@
 
 #include "smplx/smplx.hpp"
 #include "smplx/internal/cuda_util.cuh"
+#include "smplx/internal/half.hpp"
 
 namespace smplx {
 
@@ -22,17 +23,22 @@ struct {
 template<class ModelConfig>
 __host__ void Model<ModelConfig>::_cuda_load() {
     from_host_eigen_matrix(device.verts, verts);
-    from_host_eigen_matrix(device.blend_shapes, blend_shapes);
+    if (blend_shapes.rows()) {
+        from_host_eigen_matrix(device.blend_shapes, blend_shapes);
+    } else {
+        // Reduced precision blend shapes from .smplxbin, the GPU uses fp32
+        MatrixColMajor blend_shapes_fp32(3 * n_verts(), n_blend_shapes());
+        internal::to_float(blend_shapes_half.data(), blend_shapes_fp32.data(),
+                blend_shapes_fp32.size(), _blend_shapes_precision);
+        from_host_eigen_matrix(device.blend_shapes, blend_shapes_fp32);
+    }
     /* { */
     /*     // To dense */
     /*     MatrixColMajor tmp_jreg = joint_reg;  // Change to CSR */
     /*     from_host_eigen_matrix(device.joint_reg_dense, tmp_jreg); */
     /* } */
     from_host_eigen_sparse_matrix(device.joint_reg, joint_reg);
-    {
-        SparseMatrix tmp_weights = weights;  // Change to CSR
-        from_host_eigen_sparse_matrix(device.weights, tmp_weights);
-    }
+    from_host_eigen_sparse_matrix(device.weights, weights_rowmajor);
 
     if (n_hand_pca) {
         from_host_eigen_matrix(device.hand_comps_l, hand_comps_l);
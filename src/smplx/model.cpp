@@ -3,15 +3,31 @@
 #include <algorithm>
 #include <cstring>
 #include <fstream>
-#include <cnpy.h>
+#include <iostream>
+#include <Eigen/Eigenvalues>
 
 #include "smplx/util.hpp"
-#include "smplx/util_cnpy.hpp"
 #include "smplx/version.hpp"
+#include "smplx/internal/blend_tiles.hpp"
+#include "smplx/internal/half.hpp"
+#include "smplx/internal/model_file.hpp"
+#include "smplx/internal/npz_reader.hpp"
+#include "smplx/internal/uv_map.hpp"
 
 namespace smplx {
 namespace {
-using util::assert_shape;
+// Point an Eigen::Map at other data
+template<class MapType, class... Args>
+void rebind(MapType& map, Args... args) {
+    new (&map) MapType(args...);
+}
+
+// Point a sparse matrix Eigen::Map at a compressed sparse matrix
+template<class MapType, class SparseType>
+void rebind_sparse(MapType& map, const SparseType& src) {
+    new (&map) MapType(src.rows(), src.cols(), src.nonZeros(),
+            src.outerIndexPtr(), src.innerIndexPtr(), src.valuePtr());
+}
 }  // namespace
 
 template<class ModelConfig>
@@ -24,10 +40,25 @@ Model<ModelConfig>::Model(const std::string& path, const std::string& uv_path, G
     load(path, uv_path, gender);
 }
 
+template<class ModelConfig>
+Model<ModelConfig>::Model(Attach, const std::string& name, Gender gender) {
+    attach(name, gender);
+}
+
 template<class ModelConfig>
 void Model<ModelConfig>::load(Gender gender) {
-    load(util::find_data_file(std::string(ModelConfig::default_path_prefix) +
-                    util::gender_to_str(gender) + ".npz"),
+    const std::string prefix = util::find_data_file(
+            std::string(ModelConfig::default_path_prefix) + util::gender_to_str(gender));
+    const std::string bin_path = prefix + ".smplxbin", npz_path = prefix + ".npz";
+    // Prefer the .smplxbin unless the .npz was replaced after converting it
+    const double bin_mtime = internal::file_mtime(bin_path);
+    bool use_bin = bin_mtime >= 0;
+    if (use_bin && internal::file_mtime(npz_path) > bin_mtime) {
+        std::cerr << "WARNING: '" << npz_path << "' is newer than '" << bin_path <<
+            "', loading the .npz; please re-create the .smplxbin with smplx-convert\n";
+        use_bin = false;
+    }
+    load(use_bin ? bin_path : npz_path,
                 util::find_data_file(ModelConfig::default_uv_path),
                 gender);
 }
@@ -41,103 +72,557 @@ void Model<ModelConfig>::load(const std::string& path, const std::string& uv_pat
             "did you download the model following instructions in data/models/README.md?\n";
         std::exit(1);
     }
-    cnpy::npz_t npz = cnpy::npz_load(path);
+    _begin_load();
+    static const std::string BIN_EXT = ".smplxbin";
+    if (path.size() >= BIN_EXT.size() &&
+            path.compare(path.size() - BIN_EXT.size(), BIN_EXT.size(), BIN_EXT) == 0) {
+        size_t size;
+        std::shared_ptr<const void> mapped = internal::map_file(path, size);
+        _load_mapped(std::move(mapped), size, path, uv_path);
+    } else {
+        _load_npz(path, uv_path);
+    }
+    _finish_load();
+}
+
+template<class ModelConfig>
+void Model<ModelConfig>::attach(const std::string& name, Gender new_gender) {
+    gender = new_gender;
+    _begin_load();
+    size_t size;
+    std::shared_ptr<const void> mapped = internal::map_shared_memory(name, size);
+    if (!internal::load_magic_acquire(mapped.get(), size)) {
+        std::cerr << "ERROR: Shared memory '" << name << "' is not a published model, "
+            "or is still being published\n";
+        std::exit(1);
+    }
+    _load_mapped(std::move(mapped), size, "shared memory " + name, "");
+    _finish_load();
+}
+
+template<class ModelConfig>
+Model<ModelConfig> Model<ModelConfig>::attached(const std::string& name, Gender gender) {
+    return Model(Attach(), name, gender);
+}
+
+template<class ModelConfig>
+void Model<ModelConfig>::publish(const std::string& name) const {
+    internal::ModelFileWriter file;
+    _add_arrays(file);
+    const size_t size = file.file_size();
+    std::shared_ptr<void> shm = internal::create_shared_memory(name, size);
+    char* data = static_cast<char*>(shm.get());
+    // Write the magic last, so that processes attaching early fail cleanly
+    // instead of seeing partial data
+    file.write(data, ModelConfig::model_name, false);
+    internal::store_magic_release(data);
+}
+
+template<class ModelConfig>
+void Model<ModelConfig>::unpublish(const std::string& name) {
+    internal::unlink_shared_memory(name);
+}
+
+template<class ModelConfig>
+void Model<ModelConfig>::_begin_load() {
+    ++_version;
+
+    // Kintree, fixed by ModelConfig
+    if (children.empty()) {
+        children.resize(n_joints());
+        for (size_t i = 1; i < n_joints(); ++i) {
+            children[ModelConfig::parent[i]].push_back(i);
+        }
+    }
+
+    n_uv_verts = 0;
+    pose_blend_basis.resize(3 * n_verts(), 0);
+    pose_blend_coeffs.resize(0, n_pose_blends());
+    _blend_shapes_half_data.resize(0, n_blend_shapes());
+    rebind(blend_shapes_half, nullptr, 0, n_blend_shapes());
+    blend_shapes_rel_error = blend_shapes_max_pose_error = 0.f;
+    _blend_shapes_tiled_data.resize(0, 0);
+    rebind(blend_shapes_tiled, nullptr, 0, 0);
+}
 
-    // Load kintree
-    children.resize(n_joints());
-    for (size_t i = 1; i < n_joints(); ++i) {
-        children[ModelConfig::parent[i]].push_back(i);
+template<class ModelConfig>
+void Model<ModelConfig>::_finish_load() {
+    if ((_pose_blend_max_rank || _pose_blend_tol > 0.f) && !pose_blend_rank()) {
+        compress_pose_blendshapes(_pose_blend_max_rank, _pose_blend_tol);
+    }
+#ifdef SMPLX_CUDA_ENABLED
+    _cuda_load();
+#endif
+    if (_blend_shapes_precision != Precision::fp32 && blend_shapes.rows()) {
+        _encode_blend_shapes();
     }
+    _update_blend_shapes_tiled();
+}
+
+template<class ModelConfig>
+void Model<ModelConfig>::_load_npz(const std::string& path, const std::string& uv_path) {
+    _mapped.reset();
+    // Only the arrays used are read, in parallel, directly into their
+    // final storage where possible
+    internal::NpzReader npz(path);
 
     // Load base template
-    const auto& verts_raw = npz.at("v_template");
-    assert_shape(verts_raw, {n_verts(), 3});
-    verts.noalias() = util::load_float_matrix(verts_raw, n_verts(), 3);
+    _verts_data.resize(n_verts(), 3);
+    npz.add("v_template", {n_verts(), 3}, _verts_data);
 
     // Load triangle mesh
-    const auto& faces_raw = npz.at("f");
-    assert_shape(faces_raw, {n_faces(), 3});
-    faces = util::load_uint_matrix(faces_raw, n_faces(), 3);
-
-    // Load joint regressor
-    const auto& jreg_raw = npz.at("J_regressor");
-    assert_shape(jreg_raw, {n_joints(), n_verts()});
-    joint_reg.resize(n_joints(), n_verts());
-    joint_reg = util::load_float_matrix(jreg_raw, n_joints(), n_verts()).sparseView();
-    joints = joint_reg * verts;
-    joint_reg.makeCompressed();
-
-    // Load LBS weights
-    const auto& wt_raw = npz.at("weights");
-    assert_shape(wt_raw, {n_verts(), n_joints()});
-    weights.resize(n_verts(), n_joints());
-    weights = util::load_float_matrix(wt_raw, n_verts(), n_joints()).sparseView();
-    weights.makeCompressed();
-
-    blend_shapes.resize(3 * n_verts(), n_blend_shapes());
-    // Load shape-dep blend shapes
-    const auto& sb_raw = npz.at("shapedirs");
-    assert_shape(sb_raw, {n_verts(), 3, n_shape_blends()});
-    blend_shapes.template leftCols<n_shape_blends()>().noalias() =
-        util::load_float_matrix(sb_raw, 3 * n_verts(), n_shape_blends());
-
-    // Load pose-dep blend shapes
-    const auto& pb_raw = npz.at("posedirs");
-    assert_shape(pb_raw, {n_verts(), 3, n_pose_blends()});
-    blend_shapes.template rightCols<n_pose_blends()>().noalias() =
-        util::load_float_matrix(pb_raw, 3 * n_verts(), n_pose_blends());
-
-    if (n_hand_pca() && npz.count("hands_meanl") && npz.count("hands_meanr")) {
-        // Model has hand PCA (e.g. SMPLXpca), load hand PCA
-        const auto& hml_raw = npz.at("hands_meanl");
-        const auto& hmr_raw = npz.at("hands_meanr");
-        const auto& hcl_raw = npz.at("hands_componentsl");
-        const auto& hcr_raw = npz.at("hands_componentsr");
-
-        assert_shape(hml_raw, {util::ANY_SHAPE});
-        assert_shape(hmr_raw, {hml_raw.shape[0]});
-
-        size_t n_hand_params = hml_raw.shape[0];
-        _SMPLX_ASSERT_EQ(n_hand_params, n_hand_pca_joints() * 3);
+    _faces_data.resize(n_faces(), 3);
+    npz.add("f", {n_faces(), 3}, _faces_data);
+
+    // Load joint regressor and LBS weights, stored dense
+    Matrix jreg_dense(n_joints(), n_verts());
+    npz.add("J_regressor", {n_joints(), n_verts()}, jreg_dense);
+    Matrix weights_dense(n_verts(), n_joints());
+    npz.add("weights", {n_verts(), n_joints()}, weights_dense);
 
-        assert_shape(hcl_raw, {n_hand_params, n_hand_params});
-        assert_shape(hcr_raw, {n_hand_params, n_hand_params});
+    // Load shape- and pose-dep blend shapes
+    _blend_shapes_data.resize(3 * n_verts(), n_blend_shapes());
+    npz.add("shapedirs", {n_verts(), 3, n_shape_blends()},
+            _blend_shapes_data.template leftCols<n_shape_blends()>());
+    npz.add("posedirs", {n_verts(), 3, n_pose_blends()},
+            _blend_shapes_data.template rightCols<n_pose_blends()>());
 
-        hand_mean_l = util::load_float_matrix(hml_raw, n_hand_params, 1);
-        hand_mean_r = util::load_float_matrix(hmr_raw, n_hand_params, 1);
+    // Model has hand PCA (e.g. SMPLXpca), load hand PCA
+    const bool has_hand_pca = n_hand_pca() && npz.has("hands_meanl") &&
+        npz.has("hands_meanr");
+    const size_t n_hand_params = has_hand_pca ? npz.shape("hands_meanl")[0] : 0;
+    Matrix hand_comps_l_raw, hand_comps_r_raw;
+    if (has_hand_pca) {
+        _SMPLX_ASSERT_EQ(n_hand_params, n_hand_pca_joints() * 3);
+        hand_mean_l.resize(n_hand_params);
+        hand_mean_r.resize(n_hand_params);
+        hand_comps_l_raw.resize(n_hand_params, n_hand_params);
+        hand_comps_r_raw.resize(n_hand_params, n_hand_params);
+        npz.add("hands_meanl", {n_hand_params}, hand_mean_l);
+        npz.add("hands_meanr", {n_hand_params}, hand_mean_r);
+        npz.add("hands_componentsl", {n_hand_params, n_hand_params}, hand_comps_l_raw);
+        npz.add("hands_componentsr", {n_hand_params, n_hand_params}, hand_comps_r_raw);
+    }
+    npz.read();
 
-        hand_comps_l = util::load_float_matrix(hcl_raw, n_hand_params, n_hand_params)
-                           .topRows(n_hand_pca()).transpose();
-        hand_comps_r = util::load_float_matrix(hcr_raw, n_hand_params, n_hand_params)
-                           .topRows(n_hand_pca()).transpose();
+    rebind(verts, _verts_data.data(), n_verts(), 3);
+    rebind(faces, _faces_data.data(), n_faces(), 3);
+    _joint_reg_data = jreg_dense.sparseView();
+    _joint_reg_data.makeCompressed();
+    rebind_sparse(joint_reg, _joint_reg_data);
+    _weights_data = weights_dense.sparseView();
+    _weights_data.makeCompressed();
+    rebind_sparse(weights, _weights_data);
+    rebind(blend_shapes, _blend_shapes_data.data(), 3 * n_verts(), n_blend_shapes());
+    if (has_hand_pca) {
+        hand_comps_l = hand_comps_l_raw.topRows(n_hand_pca()).transpose();
+        hand_comps_r = hand_comps_r_raw.topRows(n_hand_pca()).transpose();
     }
+    _compute_derived();
 
     // Maybe load UV (UV mapping WIP)
-    if (uv_path.size()) {
-        std::ifstream ifs(uv_path);
-        ifs >> n_uv_verts;
-        if (n_uv_verts) {
-            // Currently we only support cases where there areat least as many uv
-            // verts as vertices
-            _SMPLX_ASSERT(n_uv_verts >= n_verts());
-            if (ifs) {
-                // Load the uv data
-                uv.resize(n_uv_verts, 2);
-                for (size_t i = 0; i < n_uv_verts; ++i) ifs >> uv(i, 0) >> uv(i, 1);
-                _SMPLX_ASSERT((bool)ifs);
-                uv_triangles.resize(n_faces(), 3);
-                for (size_t i = 0; i < n_faces(); ++i) {
-                    _SMPLX_ASSERT((bool)ifs);
-                    ifs >> uv_triangles(i, 0) >> uv_triangles(i, 1) >>
-                        uv_triangles(i, 2);
-                }
-                uv_triangles.array() -= 1;
-            }
+    _load_uv(uv_path);
+}
+
+template<class ModelConfig>
+void Model<ModelConfig>::_load_mapped(std::shared_ptr<const void> mapped, size_t size,
+        const std::string& source, const std::string& uv_path) {
+    using internal::DType;
+    const size_t ANY = internal::ModelFileView::ANY_DIM;
+    // The new data is mapped before releasing the old mapping, so reloading
+    // the same file reuses its pages
+    _mapped = std::move(mapped);
+    internal::ModelFileView file(_mapped.get(), size, source);
+
+    rebind(verts, file.get<Scalar>("v_template", DType::f32, {n_verts(), 3}),
+            n_verts(), 3);
+    rebind(faces, file.get<Index>("f", DType::u32, {n_faces(), 3}), n_faces(), 3);
+
+    // Sparse matrices, as compressed values/inner/outer arrays
+    const size_t jreg_nnz = file.find("J_regressor.values") ?
+        file.find("J_regressor.values")->shape[0] : 0;
+    rebind(joint_reg, n_joints(), n_verts(), jreg_nnz,
+            file.get<int>("J_regressor.outer", DType::i32, {n_joints() + 1}),
+            file.get<int>("J_regressor.inner", DType::i32, {jreg_nnz}),
+            file.get<Scalar>("J_regressor.values", DType::f32, {jreg_nnz}));
+    const size_t wt_nnz = file.find("weights.values") ?
+        file.find("weights.values")->shape[0] : 0;
+    rebind(weights, n_verts(), n_joints(), wt_nnz,
+            file.get<int>("weights.outer", DType::i32, {n_joints() + 1}),
+            file.get<int>("weights.inner", DType::i32, {wt_nnz}),
+            file.get<Scalar>("weights.values", DType::f32, {wt_nnz}));
+
+    // Derived data, checked against the CRCs of the data it was computed from
+    static const std::initializer_list<const char*> JREG_SOURCES = {"v_template",
+        "J_regressor.values", "J_regressor.inner", "J_regressor.outer"};
+    static const std::initializer_list<const char*> WEIGHTS_SOURCES = {
+        "weights.values", "weights.inner", "weights.outer"};
+    file.verify("joints", JREG_SOURCES);
+    rebind(joints, file.get<Scalar>("joints", DType::f32, {n_joints(), 3}),
+            n_joints(), 3);
+    for (const char* name : {"weights_rowmajor.values", "weights_rowmajor.inner",
+            "weights_rowmajor.outer", "vert_influence_joints",
+            "vert_influence_weights"}) {
+        file.verify(name, WEIGHTS_SOURCES);
+    }
+    rebind(weights_rowmajor, n_verts(), n_joints(), wt_nnz,
+            file.get<int>("weights_rowmajor.outer", DType::i32, {n_verts() + 1}),
+            file.get<int>("weights_rowmajor.inner", DType::i32, {wt_nnz}),
+            file.get<Scalar>("weights_rowmajor.values", DType::f32, {wt_nnz}));
+    const size_t n_influences = file.find("vert_influence_weights")->shape[1];
+    rebind(vert_influence_joints, file.get<Index>("vert_influence_joints", DType::u32,
+                {n_verts(), n_influences}), n_verts(), n_influences);
+    rebind(vert_influence_weights, file.get<Scalar>("vert_influence_weights",
+                DType::f32, {n_verts(), n_influences}), n_verts(), n_influences);
+
+    // Blend shapes, fp32 or reduced precision
+    const internal::ModelFileArray* bs = file.find("blend_shapes");
+    if (bs && bs->dtype != static_cast<uint32_t>(DType::f32)) {
+        const DType dtype = static_cast<DType>(bs->dtype);
+        _SMPLX_ASSERT(dtype == DType::f16 || dtype == DType::bf16);
+        rebind(blend_shapes_half, file.get<uint16_t>("blend_shapes", dtype,
+                    {3 * n_verts(), n_blend_shapes()}), 3 * n_verts(), n_blend_shapes());
+        rebind(blend_shapes, nullptr, 0, n_blend_shapes());
+        _blend_shapes_precision = dtype == DType::f16 ? Precision::fp16 : Precision::bf16;
+        blend_shapes_rel_error = *file.get<Scalar>("blend_shapes_rel_error",
+                DType::f32, {1});
+        blend_shapes_max_pose_error = *file.get<Scalar>("blend_shapes_max_pose_error",
+                DType::f32, {1});
+    } else {
+        rebind(blend_shapes, file.get<Scalar>("blend_shapes", DType::f32,
+                    {3 * n_verts(), n_blend_shapes()}), 3 * n_verts(), n_blend_shapes());
+    }
+
+    if (file.find("blend_shapes_tiled")) {
+        const size_t n_rows = internal::n_blend_tiles(n_verts()) * n_blend_shapes();
+        rebind(blend_shapes_tiled, file.get<Scalar>("blend_shapes_tiled", DType::f32,
+                    {n_rows, internal::BLEND_TILE_ROWS}), n_rows,
+                internal::BLEND_TILE_ROWS);
+        _blend_shapes_layout = BlendShapesLayout::tiled;
+    }
+
+    if (file.find("pose_blend_basis")) {
+        // Low-rank pose blend shapes (small), copied
+        const size_t rank = file.find("pose_blend_basis")->shape[1];
+        pose_blend_basis = Eigen::Map<const MatrixColMajor>(file.get<Scalar>(
+                    "pose_blend_basis", DType::f32, {3 * n_verts(), rank}),
+                3 * n_verts(), rank);
+        pose_blend_coeffs = Eigen::Map<const MatrixColMajor>(file.get<Scalar>(
+                    "pose_blend_coeffs", DType::f32, {rank, n_pose_blends()}),
+                rank, n_pose_blends());
+        pose_blend_rel_error = *file.get<Scalar>("pose_blend_rel_error", DType::f32, {1});
+        pose_blend_max_error = *file.get<Scalar>("pose_blend_max_error", DType::f32, {1});
+        _pose_blend_max_rank = rank;
+        _pose_blend_tol = 0.f;
+    }
+
+    if (n_hand_pca() && file.find("hand_mean_l")) {
+        // Hand PCA (small), copied
+        const size_t n_hand_params = n_hand_pca_joints() * 3;
+        hand_mean_l = Eigen::Map<const Vector>(file.get<Scalar>("hand_mean_l",
+                    DType::f32, {n_hand_params}), n_hand_params);
+        hand_mean_r = Eigen::Map<const Vector>(file.get<Scalar>("hand_mean_r",
+                    DType::f32, {n_hand_params}), n_hand_params);
+        const size_t n_comps = file.find("hand_comps_l") ?
+            file.find("hand_comps_l")->shape[1] : 0;
+        _SMPLX_ASSERT(n_comps >= n_hand_pca());
+        hand_comps_l = Eigen::Map<const Matrix>(file.get<Scalar>("hand_comps_l",
+                    DType::f32, {n_hand_params, ANY}), n_hand_params, n_comps)
+            .leftCols(n_hand_pca());
+        hand_comps_r = Eigen::Map<const Matrix>(file.get<Scalar>("hand_comps_r",
+                    DType::f32, {n_hand_params, n_comps}), n_hand_params, n_comps)
+            .leftCols(n_hand_pca());
+    }
+
+    if (file.find("uv")) {
+        _uv_map.reset();
+        n_uv_verts = file.find("uv")->shape[0];
+        _SMPLX_ASSERT(n_uv_verts >= n_verts());
+        rebind(uv, file.get<Scalar>("uv", DType::f32, {n_uv_verts, 2}), n_uv_verts, 2);
+        rebind(uv_triangles, file.get<Index>("uv_triangles", DType::u32,
+                    {n_faces(), 3}), n_faces(), 3);
+    } else {
+        _load_uv(uv_path);
+    }
+}
+
+template<class ModelConfig>
+void Model<ModelConfig>::_compute_derived() {
+    _joints_data.noalias() = joint_reg * verts;
+    rebind(joints, _joints_data.data(), n_joints(), 3);
+    _weights_rowmajor_data = weights;
+    _weights_rowmajor_data.makeCompressed();
+    rebind_sparse(weights_rowmajor, _weights_rowmajor_data);
+
+    // Vertex influence lists, from the CSR weights
+    const int* outer = _weights_rowmajor_data.outerIndexPtr();
+    const int* inner = _weights_rowmajor_data.innerIndexPtr();
+    const Scalar* values = _weights_rowmajor_data.valuePtr();
+    size_t n_influences = 0;
+    for (size_t i = 0; i < n_verts(); ++i) {
+        n_influences = std::max<size_t>(n_influences, outer[i + 1] - outer[i]);
+    }
+    _vert_influence_joints_data.setZero(n_verts(), n_influences);
+    _vert_influence_weights_data.setZero(n_verts(), n_influences);
+    std::vector<int> order;
+    for (size_t i = 0; i < n_verts(); ++i) {
+        order.resize(outer[i + 1] - outer[i]);
+        for (size_t k = 0; k < order.size(); ++k) order[k] = outer[i] + int(k);
+        std::stable_sort(order.begin(), order.end(),
+                [values](int a, int b) { return values[a] > values[b]; });
+        for (size_t k = 0; k < order.size(); ++k) {
+            _vert_influence_joints_data(i, k) = static_cast<Index>(inner[order[k]]);
+            _vert_influence_weights_data(i, k) = values[order[k]];
         }
     }
-#ifdef SMPLX_CUDA_ENABLED
-    _cuda_load();
-#endif
+    rebind(vert_influence_joints, _vert_influence_joints_data.data(),
+            n_verts(), n_influences);
+    rebind(vert_influence_weights, _vert_influence_weights_data.data(),
+            n_verts(), n_influences);
+}
+
+template<class ModelConfig>
+void Model<ModelConfig>::_load_uv(const std::string& uv_path) {
+    // Looked up before the current map is released, so that it can be reused
+    _uv_map = internal::load_uv_map(uv_path);
+    n_uv_verts = 0;
+    rebind(uv, nullptr, 0, 2);
+    rebind(uv_triangles, nullptr, 0, 3);
+    if (!_uv_map || !_uv_map->n_uv_verts) return;
+    // Currently we only support cases where there areat least as many uv
+    // verts as vertices
+    _SMPLX_ASSERT(_uv_map->n_uv_verts >= n_verts());
+    _SMPLX_ASSERT_EQ(_uv_map->n_faces, n_faces());
+    n_uv_verts = _uv_map->n_uv_verts;
+    rebind(uv, _uv_map->uv, n_uv_verts, 2);
+    rebind(uv_triangles, _uv_map->triangles, n_faces(), 3);
+}
+
+template<class ModelConfig>
+void Model<ModelConfig>::save(const std::string& path) const {
+    internal::ModelFileWriter file;
+    _add_arrays(file);
+    file.write(path, ModelConfig::model_name);
+}
+
+template<class ModelConfig>
+void Model<ModelConfig>::_add_arrays(internal::ModelFileWriter& file) const {
+    using internal::DType;
+    file.add("v_template", DType::f32, {n_verts(), 3}, verts.data());
+    file.add("f", DType::u32, {n_faces(), 3}, faces.data());
+    file.add("J_regressor.values", DType::f32,
+            {static_cast<size_t>(joint_reg.nonZeros())}, joint_reg.valuePtr());
+    file.add("J_regressor.inner", DType::i32,
+            {static_cast<size_t>(joint_reg.nonZeros())}, joint_reg.innerIndexPtr());
+    file.add("J_regressor.outer", DType::i32, {n_joints() + 1}, joint_reg.outerIndexPtr());
+    file.add("weights.values", DType::f32,
+            {static_cast<size_t>(weights.nonZeros())}, weights.valuePtr());
+    file.add("weights.inner", DType::i32,
+            {static_cast<size_t>(weights.nonZeros())}, weights.innerIndexPtr());
+    file.add("weights.outer", DType::i32, {n_joints() + 1}, weights.outerIndexPtr());
+    // Derived data, see _compute_derived
+    file.add("joints", DType::f32, {n_joints(), 3}, joints.data(), {"v_template",
+            "J_regressor.values", "J_regressor.inner", "J_regressor.outer"});
+    const std::initializer_list<const char*> weights_sources = {
+        "weights.values", "weights.inner", "weights.outer"};
+    file.add("weights_rowmajor.values", DType::f32,
+            {static_cast<size_t>(weights_rowmajor.nonZeros())},
+            weights_rowmajor.valuePtr(), weights_sources);
+    file.add("weights_rowmajor.inner", DType::i32,
+            {static_cast<size_t>(weights_rowmajor.nonZeros())},
+            weights_rowmajor.innerIndexPtr(), weights_sources);
+    file.add("weights_rowmajor.outer", DType::i32, {n_verts() + 1},
+            weights_rowmajor.outerIndexPtr(), weights_sources);
+    file.add("vert_influence_joints", DType::u32, {n_verts(), n_vert_influences()},
+            vert_influence_joints.data(), weights_sources);
+    file.add("vert_influence_weights", DType::f32, {n_verts(), n_vert_influences()},
+            vert_influence_weights.data(), weights_sources);
+    if (_blend_shapes_precision != Precision::fp32) {
+        file.add("blend_shapes", _blend_shapes_precision == Precision::fp16 ?
+                DType::f16 : DType::bf16, {3 * n_verts(), n_blend_shapes()},
+                blend_shapes_half.data());
+        file.add("blend_shapes_rel_error", DType::f32, {1}, &blend_shapes_rel_error);
+        file.add("blend_shapes_max_pose_error", DType::f32, {1},
+                &blend_shapes_max_pose_error);
+    } else {
+        file.add("blend_shapes", DType::f32, {3 * n_verts(), n_blend_shapes()},
+                blend_shapes.data());
+    }
+    if (blend_shapes_tiled.size()) {
+        file.add("blend_shapes_tiled", DType::f32,
+                {size_t(blend_shapes_tiled.rows()), internal::BLEND_TILE_ROWS},
+                blend_shapes_tiled.data());
+    }
+    if (pose_blend_rank()) {
+        file.add("pose_blend_basis", DType::f32, {3 * n_verts(), pose_blend_rank()},
+                pose_blend_basis.data());
+        file.add("pose_blend_coeffs", DType::f32, {pose_blend_rank(), n_pose_blends()},
+                pose_blend_coeffs.data());
+        file.add("pose_blend_rel_error", DType::f32, {1}, &pose_blend_rel_error);
+        file.add("pose_blend_max_error", DType::f32, {1}, &pose_blend_max_error);
+    }
+    if (n_hand_pca() && hand_comps_l.size()) {
+        const size_t n_hand_params = n_hand_pca_joints() * 3;
+        file.add("hand_mean_l", DType::f32, {n_hand_params}, hand_mean_l.data());
+        file.add("hand_mean_r", DType::f32, {n_hand_params}, hand_mean_r.data());
+        file.add("hand_comps_l", DType::f32, {n_hand_params, n_hand_pca()},
+                hand_comps_l.data());
+        file.add("hand_comps_r", DType::f32, {n_hand_params, n_hand_pca()},
+                hand_comps_r.data());
+    }
+    if (has_uv_map()) {
+        file.add("uv", DType::f32, {n_uv_verts, 2}, uv.data());
+        file.add("uv_triangles", DType::u32, {n_faces(), 3}, uv_triangles.data());
+    }
+}
+
+template<class ModelConfig>
+size_t Model<ModelConfig>::compress_pose_blendshapes(size_t max_rank, Scalar tol) {
+    decompress_pose_blendshapes();
+    if (max_rank == 0 && tol <= 0.f) return 0;
+    _pose_blend_max_rank = max_rank;
+    _pose_blend_tol = tol;
+
+    // Principal directions of the pose blend shapes, from the eigenvectors
+    // of the (small) Gram matrix; eigenvalues are in increasing order
+    MatrixColMajor pose_blends_decoded;
+    if (blend_shapes.rows() == 0) {
+        // Reduced precision blend shapes, decode pose blend shapes
+        pose_blends_decoded.resize(3 * n_verts(), n_pose_blends());
+        internal::to_float(blend_shapes_half.data() + 3 * n_verts() * n_shape_blends(),
+                pose_blends_decoded.data(), pose_blends_decoded.size(),
+                _blend_shapes_precision);
+    }
+    const Eigen::Ref<const MatrixColMajor> pose_blends = blend_shapes.rows() == 0 ?
+        Eigen::Ref<const MatrixColMajor>(pose_blends_decoded) :
+        Eigen::Ref<const MatrixColMajor>(
+                blend_shapes.template rightCols<n_pose_blends()>());
+    MatrixColMajor gram(n_pose_blends(), n_pose_blends());
+    gram.noalias() = pose_blends.transpose() * pose_blends;
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eig(gram.template cast<double>());
+    Eigen::VectorXd sq_err = eig.eigenvalues().cwiseMax(0.);
+    // sq_err(i): squared Frobenius error when dropping the i+1 smallest components
+    for (size_t i = 1; i < n_pose_blends(); ++i) sq_err(i) += sq_err(i - 1);
+    const double total = sq_err(n_pose_blends() - 1);
+
+    size_t rank = max_rank ? std::min(max_rank, n_pose_blends()) : n_pose_blends();
+    if (tol > 0.f) {
+        // Drop components while the error stays within tolerance
+        while (rank > 1 && std::sqrt(sq_err(n_pose_blends() - rank) / total) <= tol)
+            --rank;
+    }
+    if (rank >= n_pose_blends()) return 0;
+
+    pose_blend_coeffs = eig.eigenvectors().rightCols(rank).transpose()
+        .template cast<Scalar>();
+    pose_blend_basis.noalias() = pose_blends * pose_blend_coeffs.transpose();
+    pose_blend_rel_error = static_cast<Scalar>(
+            std::sqrt(sq_err(n_pose_blends() - rank - 1) / total));
+
+    // Pose blend shape params are entries of (R - I), all in [-2, 1],
+    // so 2x the max row L1 norm of the residual bounds the vertex error
+    Scalar max_resid = 0.f;
+    const size_t CHUNK_ROWS = 3 * 1024;
+    for (size_t i = 0; i < 3 * n_verts(); i += CHUNK_ROWS) {
+        const size_t n_rows = std::min(CHUNK_ROWS, 3 * n_verts() - i);
+        MatrixColMajor resid = pose_blends.middleRows(i, n_rows);
+        resid.noalias() -= pose_blend_basis.middleRows(i, n_rows) * pose_blend_coeffs;
+        max_resid = std::max(max_resid,
+                resid.cwiseAbs().rowwise().sum().maxCoeff());
+    }
+    pose_blend_max_error = 2.f * max_resid;
+    return rank;
+}
+
+template<class ModelConfig>
+void Model<ModelConfig>::decompress_pose_blendshapes() {
+    ++_version;
+    _pose_blend_max_rank = 0;
+    _pose_blend_tol = 0.f;
+    pose_blend_basis.resize(3 * n_verts(), 0);
+    pose_blend_coeffs.resize(0, n_pose_blends());
+    pose_blend_rel_error = pose_blend_max_error = 0.f;
+}
+
+template<class ModelConfig>
+void Model<ModelConfig>::set_blend_shapes_precision(Precision precision) {
+    if (precision == _blend_shapes_precision) return;
+    ++_version;
+    if (_blend_shapes_precision != Precision::fp32) {
+        // Restore fp32 blend shapes
+        _blend_shapes_data.resize(3 * n_verts(), n_blend_shapes());
+        internal::to_float(blend_shapes_half.data(), _blend_shapes_data.data(),
+                _blend_shapes_data.size(), _blend_shapes_precision);
+        rebind(blend_shapes, _blend_shapes_data.data(), 3 * n_verts(), n_blend_shapes());
+        _blend_shapes_half_data.resize(0, n_blend_shapes());
+        rebind(blend_shapes_half, nullptr, 0, n_blend_shapes());
+        blend_shapes_rel_error = blend_shapes_max_pose_error = 0.f;
+    }
+    _blend_shapes_precision = precision;
+    if (precision != Precision::fp32) _encode_blend_shapes();
+    _update_blend_shapes_tiled();
+}
+
+template<class ModelConfig>
+void Model<ModelConfig>::set_blend_shapes_layout(BlendShapesLayout layout) {
+    if (layout == _blend_shapes_layout) return;
+    ++_version;
+    _blend_shapes_layout = layout;
+    _update_blend_shapes_tiled();
+}
+
+template<class ModelConfig>
+void Model<ModelConfig>::_update_blend_shapes_tiled() {
+    if (_blend_shapes_layout != BlendShapesLayout::tiled || !blend_shapes.rows()) {
+        _blend_shapes_tiled_data.resize(0, 0);
+        rebind(blend_shapes_tiled, nullptr, 0, 0);
+        return;
+    }
+    // Already built, or mapped from a .smplxbin file
+    if (blend_shapes_tiled.size()) return;
+    _blend_shapes_tiled_data.resize(internal::n_blend_tiles(n_verts()) * n_blend_shapes(),
+            internal::BLEND_TILE_ROWS);
+    internal::pack_blend_tiles(blend_shapes.data(), 3 * n_verts(), n_blend_shapes(),
+            _blend_shapes_tiled_data.data());
+    rebind(blend_shapes_tiled, _blend_shapes_tiled_data.data(),
+            _blend_shapes_tiled_data.rows(), internal::BLEND_TILE_ROWS);
+}
+
+template<class ModelConfig>
+void Model<ModelConfig>::_encode_blend_shapes() {
+    _blend_shapes_half_data.resize(3 * n_verts(), n_blend_shapes());
+    internal::from_float(blend_shapes.data(), _blend_shapes_half_data.data(),
+            blend_shapes.size(), _blend_shapes_precision);
+    rebind(blend_shapes_half, _blend_shapes_half_data.data(), 3 * n_verts(),
+            n_blend_shapes());
+
+    // Accuracy of the reduced precision blend shapes; as for
+    // compress_pose_blendshapes, 2x the max row L1 norm of the pose blend
+    // shape error bounds the vertex error
+    double sq_err = 0., sq_norm = 0.;
+    Scalar max_resid = 0.f;
+    const size_t CHUNK_ROWS = 3 * 1024;
+    MatrixColMajor resid;
+    for (size_t i = 0; i < 3 * n_verts(); i += CHUNK_ROWS) {
+        const size_t n_rows = std::min(CHUNK_ROWS, 3 * n_verts() - i);
+        resid.resize(n_rows, n_blend_shapes());
+        for (size_t j = 0; j < n_blend_shapes(); ++j) {
+            internal::to_float(blend_shapes_half.data() + j * 3 * n_verts() + i,
+                    resid.col(j).data(), n_rows,
+                    _blend_shapes_precision);
+        }
+        resid -= blend_shapes.middleRows(i, n_rows);
+        sq_err += resid.squaredNorm();
+        sq_norm += blend_shapes.middleRows(i, n_rows).squaredNorm();
+        max_resid = std::max(max_resid, resid.template rightCols<n_pose_blends()>()
+                .cwiseAbs().rowwise().sum().maxCoeff());
+    }
+    blend_shapes_rel_error = static_cast<Scalar>(std::sqrt(sq_err / sq_norm));
+    blend_shapes_max_pose_error = 2.f * max_resid;
+    // Release fp32 blend shapes (if mapped from a file, the pages are only
+    // dropped from the page cache once unused)
+    rebind(blend_shapes, nullptr, 0, n_blend_shapes());
+    _blend_shapes_data.resize(0, n_blend_shapes());
 }
 
 template<class ModelConfig>
@@ -156,9 +641,11 @@ template class Model<model_config::SMPLXpca>;
 
 // Model config constexpr arrays
 namespace model_config {
+constexpr size_t SMPLXpca::parent[];
 constexpr size_t SMPLX::parent[];
 constexpr size_t SMPLH::parent[];
 constexpr size_t SMPL::parent[];
+constexpr const char* SMPLXpca::joint_name[];
 constexpr const char* SMPLX::joint_name[];
 constexpr const char* SMPLH::joint_name[];
 constexpr const char* SMPL::joint_name[];
@@ -0,0 +1,124 @@
+#include "smplx/model_cache.hpp"
+
+#include <fstream>
+#include <thread>
+#include <vector>
+
+#include "smplx/util.hpp"
+
+namespace smplx {
+
+ModelCache& ModelCache::global() {
+    static ModelCache cache;
+    return cache;
+}
+
+void ModelCache::set_memory_budget(size_t bytes) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _budget = bytes;
+    _evict();
+}
+
+size_t ModelCache::memory_budget() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _budget;
+}
+
+size_t ModelCache::memory_usage() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _usage;
+}
+
+size_t ModelCache::size() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _entries.size();
+}
+
+void ModelCache::clear() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _entries.clear();
+    _lru.clear();
+    _usage = 0;
+}
+
+std::string ModelCache::_key(const char* model_name, Gender gender,
+        const std::string& path, const std::string& uv_path) {
+    return std::string(model_name) + '\n' + util::gender_to_str(gender) + '\n' +
+        path + '\n' + uv_path;
+}
+
+std::shared_ptr<const void> ModelCache::_get(const std::string& key,
+        const std::function<Entry::Value()>& load) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    auto it = _entries.find(key);
+    if (it != _entries.end()) {
+        _lru.splice(_lru.begin(), _lru, it->second.lru_pos);
+        std::shared_future<Entry::Value> value = it->second.value;
+        lock.unlock();
+        // Waits if another thread is still loading the model
+        return value.get().first;
+    }
+
+    // Load without holding the lock; concurrent requests wait on the future
+    std::promise<Entry::Value> promise;
+    Entry& entry = _entries[key];
+    entry.value = promise.get_future().share();
+    entry.id = _next_id++;
+    _lru.push_front(key);
+    entry.lru_pos = _lru.begin();
+    const uint64_t id = entry.id;
+    lock.unlock();
+
+    Entry::Value value;
+    try {
+        value = load();
+    } catch (...) {
+        promise.set_exception(std::current_exception());
+        lock.lock();
+        it = _entries.find(key);
+        if (it != _entries.end() && it->second.id == id) {
+            _lru.erase(it->second.lru_pos);
+            _entries.erase(it);
+        }
+        throw;
+    }
+    promise.set_value(value);
+
+    lock.lock();
+    it = _entries.find(key);
+    if (it != _entries.end() && it->second.id == id) {
+        it->second.loaded = true;
+        _usage += value.second;
+        _evict();
+    }
+    return value.first;
+}
+
+void ModelCache::_evict() {
+    if (_budget == 0) return;
+    for (auto it = _lru.end(); it != _lru.begin() && _usage > _budget; ) {
+        --it;
+        Entry& entry = _entries.at(*it);
+        if (!entry.loaded) continue;
+        const Entry::Value& value = entry.value.get();
+        // Only the cache holds it
+        if (value.first.use_count() > 1) continue;
+        _usage -= value.second;
+        _entries.erase(*it);
+        it = _lru.erase(it);
+    }
+}
+
+void ModelCache::_preload(const std::function<void(Gender)>& get,
+        const char* path_prefix) {
+    std::vector<std::thread> threads;
+    for (Gender gender : {Gender::neutral, Gender::male, Gender::female}) {
+        const std::string prefix = util::find_data_file(
+                std::string(path_prefix) + util::gender_to_str(gender));
+        if (!std::ifstream(prefix + ".smplxbin") && !std::ifstream(prefix + ".npz")) continue;
+        threads.emplace_back(get, gender);
+    }
+    for (auto& thd : threads) thd.join();
+}
+
+}  // namespace smplx
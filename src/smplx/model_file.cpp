@@ -0,0 +1,370 @@
+#include "smplx/internal/model_file.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <zlib.h>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace smplx {
+namespace internal {
+
+namespace {
+size_t align_up(size_t x) {
+    return (x + MODEL_FILE_ALIGN - 1) / MODEL_FILE_ALIGN * MODEL_FILE_ALIGN;
+}
+
+bool host_is_little_endian() {
+    const uint16_t x = 1;
+    unsigned char c;
+    std::memcpy(&c, &x, 1);
+    return c == 1;
+}
+
+// CRC-32 of data, in chunks since zlib takes 32-bit lengths
+uint32_t data_crc32(const void* data, size_t nbytes) {
+    const Bytef* p = static_cast<const Bytef*>(data);
+    uLong crc = crc32(0L, Z_NULL, 0);
+    while (nbytes) {
+        const uInt n = static_cast<uInt>(std::min<size_t>(nbytes, 1u << 30));
+        crc = crc32(crc, p, n);
+        p += n;
+        nbytes -= n;
+    }
+    return static_cast<uint32_t>(crc);
+}
+
+// CRC-32 of a list of CRCs, identifying the data of the arrays they belong to
+uint32_t crcs_crc32(const std::vector<uint32_t>& crcs) {
+    return data_crc32(crcs.data(), crcs.size() * sizeof(uint32_t));
+}
+
+[[noreturn]] void file_error(const std::string& source, const std::string& msg) {
+    std::cerr << "ERROR: Invalid model file '" << source << "': " << msg << "\n";
+    std::exit(1);
+}
+}  // namespace
+
+size_t dtype_size(DType dtype) {
+    switch (dtype) {
+        case DType::f32: case DType::i32: case DType::u32: return 4;
+        case DType::f16: case DType::bf16: return 2;
+    }
+    return 0;
+}
+
+ModelFileView::ModelFileView(const void* data, size_t size, const std::string& source)
+    : _data(static_cast<const char*>(data)), _source(source) {
+    if (!host_is_little_endian()) file_error(source, "big-endian hosts are not supported");
+    if (size < sizeof(ModelFileHeader)) file_error(source, "file too small");
+    _header = reinterpret_cast<const ModelFileHeader*>(_data);
+    if (std::memcmp(_header->magic, MODEL_FILE_MAGIC, sizeof(MODEL_FILE_MAGIC)))
+        file_error(source, "not a .smplxbin file");
+    if (_header->version != MODEL_FILE_VERSION)
+        file_error(source, "unsupported version " + std::to_string(_header->version) +
+                ", please re-create it with smplx-convert");
+    if (_header->file_size != size) file_error(source, "truncated");
+    if (!std::memchr(_header->model_name, 0, sizeof(_header->model_name)))
+        file_error(source, "bad model name");
+    if (sizeof(ModelFileHeader) + _header->n_arrays * sizeof(ModelFileArray) > size)
+        file_error(source, "truncated array table");
+    _arrays = reinterpret_cast<const ModelFileArray*>(_data + sizeof(ModelFileHeader));
+    for (size_t i = 0; i < _header->n_arrays; ++i) {
+        const ModelFileArray& arr = _arrays[i];
+        // Names are compared and printed as C strings
+        if (!std::memchr(arr.name, 0, sizeof(arr.name)))
+            file_error(source, "bad name for array " + std::to_string(i));
+        if (arr.offset % MODEL_FILE_ALIGN || arr.offset > size ||
+                arr.nbytes > size - arr.offset) {
+            file_error(source, std::string("bad extent for array '") + arr.name + "'");
+        }
+    }
+}
+
+const ModelFileArray* ModelFileView::find(const std::string& name) const {
+    for (size_t i = 0; i < _header->n_arrays; ++i) {
+        if (name == _arrays[i].name) return &_arrays[i];
+    }
+    return nullptr;
+}
+
+const void* ModelFileView::get(const std::string& name, DType dtype,
+        std::initializer_list<size_t> shape) const {
+    const ModelFileArray* arr = find(name);
+    if (!arr) file_error(_source, "missing array '" + name + "'");
+    if (arr->dtype != static_cast<uint32_t>(dtype))
+        file_error(_source, "unexpected type for array '" + name + "'");
+    if (arr->ndim != shape.size())
+        file_error(_source, "unexpected shape for array '" + name + "'");
+    size_t numel = 1, i = 0;
+    for (size_t dim : shape) {
+        if (dim != ANY_DIM && arr->shape[i] != dim)
+            file_error(_source, "unexpected shape for array '" + name + "'");
+        numel *= arr->shape[i++];
+    }
+    if (arr->nbytes != numel * dtype_size(dtype))
+        file_error(_source, "bad size for array '" + name + "'");
+    return _data + arr->offset;
+}
+
+void ModelFileView::verify(const std::string& name,
+        std::initializer_list<const char*> sources) const {
+    const ModelFileArray* arr = find(name);
+    if (!arr) file_error(_source, "missing array '" + name + "'");
+    if (data_crc32(_data + arr->offset, arr->nbytes) != arr->crc32)
+        file_error(_source, "checksum mismatch for array '" + name + "'");
+    if (!sources.size()) return;
+    std::vector<uint32_t> crcs;
+    for (const char* src : sources) {
+        verify(src);
+        crcs.push_back(find(src)->crc32);
+    }
+    if (crcs_crc32(crcs) != arr->source_crc32)
+        file_error(_source, "array '" + name + "' is out of date, "
+                "please re-create the file with smplx-convert");
+}
+
+void ModelFileView::verify_all() const {
+    for (size_t i = 0; i < _header->n_arrays; ++i) verify(_arrays[i].name);
+}
+
+void ModelFileWriter::add(const std::string& name, DType dtype,
+        std::initializer_list<size_t> shape, const void* data,
+        std::initializer_list<const char*> sources) {
+    ModelFileArray arr = {};
+    if (name.size() >= sizeof(arr.name) || shape.size() > 2) {
+        std::cerr << "ERROR: Invalid array '" << name << "' for model file\n";
+        std::exit(1);
+    }
+    std::strncpy(arr.name, name.c_str(), sizeof(arr.name) - 1);
+    arr.dtype = static_cast<uint32_t>(dtype);
+    arr.ndim = static_cast<uint32_t>(shape.size());
+    size_t numel = 1, i = 0;
+    for (size_t dim : shape) {
+        arr.shape[i++] = dim;
+        numel *= dim;
+    }
+    arr.nbytes = numel * dtype_size(dtype);
+    _arrays.push_back(arr);
+    _data.push_back(data);
+    _sources.emplace_back(sources.begin(), sources.end());
+}
+
+size_t ModelFileWriter::file_size() const {
+    size_t size = align_up(sizeof(ModelFileHeader) + _arrays.size() * sizeof(ModelFileArray));
+    for (const auto& arr : _arrays) size = align_up(size + arr.nbytes);
+    return size;
+}
+
+void ModelFileWriter::write(char* out, const char* model_name, bool write_magic) const {
+    const size_t size = file_size();
+    std::memset(out, 0, size);
+    ModelFileHeader header = {};
+    if (write_magic) std::memcpy(header.magic, MODEL_FILE_MAGIC, sizeof(MODEL_FILE_MAGIC));
+    header.version = MODEL_FILE_VERSION;
+    header.n_arrays = static_cast<uint32_t>(_arrays.size());
+    header.file_size = size;
+    std::strncpy(header.model_name, model_name, sizeof(header.model_name) - 1);
+    std::memcpy(out, &header, sizeof(header));
+
+    std::vector<uint32_t> crcs(_arrays.size());
+    for (size_t i = 0; i < _arrays.size(); ++i) {
+        crcs[i] = data_crc32(_data[i], _arrays[i].nbytes);
+    }
+    size_t offset = align_up(sizeof(ModelFileHeader) + _arrays.size() * sizeof(ModelFileArray));
+    for (size_t i = 0; i < _arrays.size(); ++i) {
+        ModelFileArray arr = _arrays[i];
+        arr.offset = offset;
+        arr.crc32 = crcs[i];
+        if (_sources[i].size()) {
+            std::vector<uint32_t> source_crcs;
+            for (const std::string& src : _sources[i]) {
+                size_t j = 0;
+                while (j < _arrays.size() && src != _arrays[j].name) ++j;
+                if (j == _arrays.size()) {
+                    std::cerr << "ERROR: Missing source array '" << src << "' of '" <<
+                        arr.name << "' for model file\n";
+                    std::exit(1);
+                }
+                source_crcs.push_back(crcs[j]);
+            }
+            arr.source_crc32 = crcs_crc32(source_crcs);
+        }
+        std::memcpy(out + sizeof(ModelFileHeader) + i * sizeof(ModelFileArray),
+                &arr, sizeof(arr));
+        if (arr.nbytes) std::memcpy(out + offset, _data[i], arr.nbytes);
+        offset = align_up(offset + arr.nbytes);
+    }
+}
+
+void ModelFileWriter::write(const std::string& path, const char* model_name) const {
+    std::vector<char> buf(file_size());
+    write(buf.data(), model_name);
+    // Write to a temporary file and rename it over path: truncating path in
+    // place would fault processes that have it mapped (e.g. when
+    // re-converting models in use, or converting a file onto itself)
+    const std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream ofs(tmp_path, std::ios::binary);
+        ofs.write(buf.data(), buf.size());
+        if (!ofs) {
+            std::remove(tmp_path.c_str());
+            std::cerr << "ERROR: Failed to write model file '" << path << "'\n";
+            std::exit(1);
+        }
+    }
+#ifdef _WIN32
+    const bool renamed = MoveFileExA(tmp_path.c_str(), path.c_str(),
+            MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    const bool renamed = std::rename(tmp_path.c_str(), path.c_str()) == 0;
+#endif
+    if (!renamed) {
+        std::remove(tmp_path.c_str());
+        std::cerr << "ERROR: Failed to replace model file '" << path << "'\n";
+        std::exit(1);
+    }
+}
+
+double file_mtime(const std::string& path) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) return -1.0;
+    return static_cast<double>(st.st_mtime);
+}
+
+std::shared_ptr<const void> map_file(const std::string& path, size_t& size) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    LARGE_INTEGER file_size;
+    if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &file_size)) {
+        std::cerr << "ERROR: Failed to open '" << path << "'\n";
+        std::exit(1);
+    }
+    size = static_cast<size_t>(file_size.QuadPart);
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    const void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (mapping) CloseHandle(mapping);
+    if (!data) {
+        std::cerr << "ERROR: Failed to map '" << path << "'\n";
+        std::exit(1);
+    }
+    return std::shared_ptr<const void>(data, [](const void* p) {
+        UnmapViewOfFile(p);
+    });
+#else
+    const int fd = open(path.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        std::cerr << "ERROR: Failed to open '" << path << "'\n";
+        std::exit(1);
+    }
+    size = static_cast<size_t>(st.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        std::cerr << "ERROR: Failed to map '" << path << "'\n";
+        std::exit(1);
+    }
+    return std::shared_ptr<const void>(data, [size](const void* p) {
+        munmap(const_cast<void*>(p), size);
+    });
+#endif
+}
+
+#ifdef _WIN32
+std::shared_ptr<void> create_shared_memory(const std::string& name, size_t size) {
+    std::cerr << "ERROR: Shared memory models are not supported on Windows\n";
+    std::exit(1);
+}
+
+std::shared_ptr<const void> map_shared_memory(const std::string& name, size_t& size) {
+    std::cerr << "ERROR: Shared memory models are not supported on Windows\n";
+    std::exit(1);
+}
+
+void unlink_shared_memory(const std::string& name) {}
+#else
+std::shared_ptr<void> create_shared_memory(const std::string& name, size_t size) {
+    // Replace any existing segment; processes attached to it keep their mapping
+    shm_unlink(name.c_str());
+    const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0 || ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        std::cerr << "ERROR: Failed to create shared memory '" << name << "'\n";
+        std::exit(1);
+    }
+    void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        std::cerr << "ERROR: Failed to map shared memory '" << name << "'\n";
+        std::exit(1);
+    }
+    return std::shared_ptr<void>(data, [size](void* p) { munmap(p, size); });
+}
+
+std::shared_ptr<const void> map_shared_memory(const std::string& name, size_t& size) {
+    const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        std::cerr << "ERROR: Shared memory '" << name << "' does not exist, "
+            "was the model published?\n";
+        std::exit(1);
+    }
+    size = static_cast<size_t>(st.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        std::cerr << "ERROR: Failed to map shared memory '" << name << "'\n";
+        std::exit(1);
+    }
+    return std::shared_ptr<const void>(data, [size](const void* p) {
+        munmap(const_cast<void*>(p), size);
+    });
+}
+
+void unlink_shared_memory(const std::string& name) {
+    shm_unlink(name.c_str());
+}
+#endif
+
+namespace {
+// The magic, as one 8-byte word at the (page-aligned) start of the file
+using AtomicMagic = std::atomic<uint64_t>;
+static_assert(AtomicMagic::is_always_lock_free && sizeof(AtomicMagic) ==
+        sizeof(MODEL_FILE_MAGIC), "model file magic must be a lock-free word");
+
+uint64_t magic_word() {
+    uint64_t word;
+    std::memcpy(&word, MODEL_FILE_MAGIC, sizeof(word));
+    return word;
+}
+}  // namespace
+
+void store_magic_release(void* data) {
+    reinterpret_cast<AtomicMagic*>(data)->store(magic_word(), std::memory_order_release);
+}
+
+bool load_magic_acquire(const void* data, size_t size) {
+    if (size < sizeof(MODEL_FILE_MAGIC)) return false;
+    return reinterpret_cast<const AtomicMagic*>(data)->load(std::memory_order_acquire) ==
+        magic_word();
+}
+
+}  // namespace internal
+}  // namespace smplx
@@ -0,0 +1,619 @@
+#include "smplx/internal/npz_reader.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <zlib.h>
+
+#include "smplx/internal/model_file.hpp"
+#include "smplx/internal/thread_pool.hpp"
+
+namespace smplx {
+namespace internal {
+
+namespace {
+// Bytes of .npy data converted per step when the file's element type or
+// layout differs from the destination's
+constexpr size_t CONVERT_CHUNK = 1 << 16;
+
+template<class T>
+T load_le(const unsigned char* p) {
+    T x = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) x |= T(p[i]) << (8 * i);
+    return x;
+}
+
+// Deflate window size
+constexpr size_t WINDOW = 1 << 15;
+// Minimum uncompressed bytes between access points of a seek index
+constexpr uint64_t ACCESS_POINT_SPAN = 1 << 18;
+}  // namespace
+
+// Points at which inflation of an entry can be restarted, as in zlib's
+// zran example: the compressed position (in bytes, plus bits if not on a
+// byte boundary) of a deflate block boundary, and the last 32K of
+// uncompressed data before it
+struct NpzReader::SeekIndex {
+    struct AccessPoint {
+        uint64_t out, in;
+        int bits;
+        std::vector<unsigned char> window;
+    };
+    std::mutex mutex;
+    // Sorted by out
+    std::vector<AccessPoint> points;
+};
+
+namespace {
+// Sequential reader for the uncompressed contents of a zip entry
+class EntryStream {
+public:
+    // index: if not null, reading records access points into it and seek
+    //        starts from them, for deflated entries
+    EntryStream(const unsigned char* data, uint64_t compressed_size, uint16_t method,
+            NpzReader::SeekIndex* index = nullptr)
+        : _data(data), _in(data), _in_left(compressed_size),
+          _deflate(method == 8), _index(_deflate ? index : nullptr) {
+        if (_deflate) {
+            std::memset(&_zs, 0, sizeof(_zs));
+            // Raw deflate stream, as stored in zip files
+            inflateInit2(&_zs, -MAX_WBITS);
+        }
+        if (_index) _window.resize(WINDOW);
+    }
+
+    ~EntryStream() {
+        if (_deflate) inflateEnd(&_zs);
+    }
+
+    // Read exactly n bytes into out (or skip them if out is null); returns
+    // false if the entry is truncated or corrupt
+    bool read(void* out, size_t n) {
+        unsigned char* out_bytes = static_cast<unsigned char*>(out);
+        if (!_deflate) {
+            if (n > _in_left) return false;
+            if (out_bytes) std::memcpy(out_bytes, _in, n);
+            _in += n;
+            _in_left -= n;
+            _pos += n;
+            return true;
+        }
+        if (_index) return _read_indexed(out_bytes, n);
+        unsigned char scratch[4096];
+        while (n) {
+            _feed();
+            const uInt want = out_bytes ? uInt(std::min<size_t>(n, UINT_MAX)) :
+                uInt(std::min(n, sizeof(scratch)));
+            _zs.next_out = out_bytes ? out_bytes : scratch;
+            _zs.avail_out = want;
+            const int ret = inflate(&_zs, Z_NO_FLUSH);
+            const size_t got = want - _zs.avail_out;
+            if (out_bytes) out_bytes += got;
+            n -= got;
+            _pos += got;
+            if (ret == Z_STREAM_END) return n == 0;
+            if (ret != Z_OK) return false;
+        }
+        return true;
+    }
+
+    // Move forward to uncompressed position pos
+    bool seek(uint64_t pos) {
+        if (pos < _pos) return false;
+        if (_index) {
+            // Restart from the last access point at or before pos, if ahead
+            std::lock_guard<std::mutex> lock(_index->mutex);
+            const auto& points = _index->points;
+            auto it = std::upper_bound(points.begin(), points.end(), pos,
+                [](uint64_t p, const NpzReader::SeekIndex::AccessPoint& pt) {
+                    return p < pt.out;
+                });
+            if (it != points.begin() && (--it)->out > _pos) _restore(*it);
+        }
+        return read(nullptr, pos - _pos);
+    }
+
+private:
+    void _feed() {
+        if (_zs.avail_in == 0 && _in_left) {
+            const uInt feed = uInt(std::min<uint64_t>(_in_left, UINT_MAX));
+            _zs.next_in = const_cast<Bytef*>(_in);
+            _zs.avail_in = feed;
+            _in += feed;
+            _in_left -= feed;
+        }
+    }
+
+    // Inflate through the window, recording access points at block
+    // boundaries
+    bool _read_indexed(unsigned char* out, size_t n) {
+        while (n) {
+            if (_win_have == WINDOW) _win_have = 0;
+            _feed();
+            const uInt want = uInt(std::min(n, WINDOW - _win_have));
+            _zs.next_out = _window.data() + _win_have;
+            _zs.avail_out = want;
+            const int ret = inflate(&_zs, Z_BLOCK);
+            const size_t got = want - _zs.avail_out;
+            if (out) {
+                std::memcpy(out, _window.data() + _win_have, got);
+                out += got;
+            }
+            _win_have += got;
+            _pos += got;
+            n -= got;
+            if (ret == Z_STREAM_END) return n == 0;
+            if (ret != Z_OK) return false;
+            if ((_zs.data_type & 128) && !(_zs.data_type & 64)) _add_point();
+        }
+        return true;
+    }
+
+    void _add_point() {
+        std::lock_guard<std::mutex> lock(_index->mutex);
+        auto& points = _index->points;
+        if (_pos < (points.empty() ? ACCESS_POINT_SPAN :
+                    points.back().out + ACCESS_POINT_SPAN)) return;
+        NpzReader::SeekIndex::AccessPoint point;
+        point.out = _pos;
+        point.in = uint64_t(_in - _data) - _zs.avail_in;
+        point.bits = _zs.data_type & 7;
+        // Window in order of output: oldest data starts at _win_have
+        point.window.resize(WINDOW);
+        std::memcpy(point.window.data(), _window.data() + _win_have, WINDOW - _win_have);
+        std::memcpy(point.window.data() + WINDOW - _win_have, _window.data(), _win_have);
+        points.push_back(std::move(point));
+    }
+
+    void _restore(const NpzReader::SeekIndex::AccessPoint& point) {
+        const uint64_t total = uint64_t(_in - _data) + _in_left;
+        inflateReset(&_zs);
+        _zs.avail_in = 0;
+        uint64_t in = point.in;
+        if (point.bits) {
+            // Partial byte preceding the access point
+            --in;
+            inflatePrime(&_zs, point.bits, _data[in] >> (8 - point.bits));
+            ++in;
+        }
+        _in = _data + in;
+        _in_left = total - in;
+        inflateSetDictionary(&_zs, point.window.data(), WINDOW);
+        std::memcpy(_window.data(), point.window.data(), WINDOW);
+        _win_have = WINDOW;
+        _pos = point.out;
+    }
+
+    const unsigned char* _data;
+    const unsigned char* _in;
+    uint64_t _in_left;
+    bool _deflate;
+    z_stream _zs;
+    // Position in uncompressed data
+    uint64_t _pos = 0;
+    NpzReader::SeekIndex* _index;
+    // Last 32K of uncompressed data (circular), if indexed
+    std::vector<unsigned char> _window;
+    size_t _win_have = 0;
+};
+
+// Convert n elements of type Src at src to dst[0], dst[stride], ...
+template<class Src, class Dst>
+void convert_run(const char* src, size_t n, Dst* dst, size_t stride) {
+    for (size_t i = 0; i < n; ++i) {
+        Src x;
+        std::memcpy(&x, src + i * sizeof(Src), sizeof(Src));
+        dst[i * stride] = static_cast<Dst>(x);
+    }
+}
+
+template<class Dst>
+void convert_run(NpzReader::DType dtype, const char* src, size_t n, Dst* dst,
+        size_t stride) {
+    using DType = NpzReader::DType;
+    switch (dtype) {
+        case DType::f32: convert_run<float>(src, n, dst, stride); break;
+        case DType::f64: convert_run<double>(src, n, dst, stride); break;
+        case DType::i32: convert_run<int32_t>(src, n, dst, stride); break;
+        case DType::i64: convert_run<int64_t>(src, n, dst, stride); break;
+        case DType::u32: convert_run<uint32_t>(src, n, dst, stride); break;
+        case DType::u64: convert_run<uint64_t>(src, n, dst, stride); break;
+        case DType::u8: convert_run<uint8_t>(src, n, dst, stride); break;
+        default: break;
+    }
+}
+
+// Stream numel elements from stream into dst, converting each element and
+// scattering it to dst[outer * outer_stride + inner * inner_stride], where
+// inner is the fastest-varying index in the file
+template<class Dst>
+bool read_converted(EntryStream& stream, const NpzReader::ArrayInfo& info, size_t numel,
+        Dst* dst, size_t inner_n, size_t inner_stride, size_t outer_stride) {
+    std::vector<char> buf(CONVERT_CHUNK);
+    const size_t chunk_elems = CONVERT_CHUNK / info.word_size;
+    size_t left = numel, inner = 0, outer = 0;
+    while (left) {
+        const size_t n = std::min(left, chunk_elems);
+        if (!stream.read(buf.data(), n * info.word_size)) return false;
+        for (size_t k = 0; k < n; ) {
+            const size_t run = std::min(n - k, inner_n - inner);
+            convert_run(info.dtype, buf.data() + k * info.word_size, run,
+                    dst + outer * outer_stride + inner * inner_stride, inner_stride);
+            k += run;
+            inner += run;
+            if (inner == inner_n) {
+                inner = 0;
+                ++outer;
+            }
+        }
+        left -= n;
+    }
+    return true;
+}
+}  // namespace
+
+size_t NpzReader::ArrayInfo::numel() const {
+    size_t n = 1;
+    for (size_t dim : shape) n *= dim;
+    return n;
+}
+
+NpzReader::NpzReader(const std::string& path) : _path(path) {
+    _mapped = map_file(path, _file_size);
+    _data = static_cast<const unsigned char*>(_mapped.get());
+
+    // Find end of central directory record, which may be followed by a
+    // comment of up to 64K
+    if (_file_size < 22) _error("not a zip archive");
+    size_t eocd = 0;
+    bool found = false;
+    for (size_t i = _file_size - 22; ; --i) {
+        if (load_le<uint32_t>(_data + i) == 0x06054b50) {
+            eocd = i;
+            found = true;
+            break;
+        }
+        if (i == 0 || _file_size - i >= 22 + 0xFFFF) break;
+    }
+    if (!found) _error("not a zip archive");
+    uint64_t n_entries = load_le<uint16_t>(_data + eocd + 10);
+    uint64_t cd_size = load_le<uint32_t>(_data + eocd + 12);
+    uint64_t cd_offset = load_le<uint32_t>(_data + eocd + 16);
+    if (n_entries == 0xFFFF || cd_size == 0xFFFFFFFF || cd_offset == 0xFFFFFFFF) {
+        // Zip64 end of central directory record, located by the record
+        // preceding the end of central directory record
+        if (eocd < 20 || load_le<uint32_t>(_data + eocd - 20) != 0x07064b50)
+            _error("bad zip64 end of central directory");
+        const uint64_t rec = load_le<uint64_t>(_data + eocd - 20 + 8);
+        if (rec > _file_size - 56 || load_le<uint32_t>(_data + rec) != 0x06064b50)
+            _error("bad zip64 end of central directory");
+        n_entries = load_le<uint64_t>(_data + rec + 32);
+        cd_size = load_le<uint64_t>(_data + rec + 40);
+        cd_offset = load_le<uint64_t>(_data + rec + 48);
+    }
+    if (cd_offset > _file_size || cd_size > _file_size - cd_offset)
+        _error("bad central directory");
+
+    // Index central directory
+    const unsigned char* p = _data + cd_offset;
+    const unsigned char* cd_end = p + cd_size;
+    for (uint64_t i = 0; i < n_entries; ++i) {
+        if (cd_end - p < 46 || load_le<uint32_t>(p) != 0x02014b50)
+            _error("bad central directory");
+        Entry entry;
+        const uint16_t flags = load_le<uint16_t>(p + 8);
+        entry.method = load_le<uint16_t>(p + 10);
+        entry.compressed_size = load_le<uint32_t>(p + 20);
+        entry.size = load_le<uint32_t>(p + 24);
+        const size_t name_len = load_le<uint16_t>(p + 28);
+        const size_t extra_len = load_le<uint16_t>(p + 30);
+        const size_t comment_len = load_le<uint16_t>(p + 32);
+        entry.header_offset = load_le<uint32_t>(p + 42);
+        if (size_t(cd_end - p) < 46 + name_len + extra_len + comment_len)
+            _error("bad central directory");
+        std::string name(reinterpret_cast<const char*>(p + 46), name_len);
+
+        // Zip64 extended information, present for fields set to 0xFFFFFFFF
+        const unsigned char* extra = p + 46 + name_len;
+        const unsigned char* extra_end = extra + extra_len;
+        while (extra_end - extra >= 4) {
+            const uint16_t id = load_le<uint16_t>(extra);
+            const size_t len = load_le<uint16_t>(extra + 2);
+            const unsigned char* field = extra + 4;
+            const unsigned char* field_end = field + std::min<size_t>(len, extra_end - field);
+            if (id == 0x0001) {
+                for (uint64_t* val : {&entry.size, &entry.compressed_size,
+                        &entry.header_offset}) {
+                    if (*val != 0xFFFFFFFF) continue;
+                    if (field_end - field < 8) _error("bad zip64 extra field");
+                    *val = load_le<uint64_t>(field);
+                    field += 8;
+                }
+            }
+            extra = field_end;
+        }
+        p += 46 + name_len + extra_len + comment_len;
+
+        if (flags & 1) _error("encrypted entry '" + name + "'");
+        // numpy names entries <key>.npy
+        if (name.size() > 4 && name.compare(name.size() - 4, 4, ".npy") == 0)
+            name.resize(name.size() - 4);
+        _entries[name] = std::move(entry);
+    }
+}
+
+NpzReader::~NpzReader() = default;
+
+bool NpzReader::has(const std::string& key) const {
+    return _entries.count(key) > 0;
+}
+
+NpzReader::Entry& NpzReader::_entry(const std::string& key) {
+    auto it = _entries.find(key);
+    if (it == _entries.end()) _error("missing array '" + key + "'");
+    return it->second;
+}
+
+const unsigned char* NpzReader::_entry_data(const Entry& entry) const {
+    std::string err;
+    const unsigned char* data = _entry_data(entry, err);
+    if (!data) _error(err);
+    return data;
+}
+
+const unsigned char* NpzReader::_entry_data(const Entry& entry, std::string& err) const {
+    if (entry.method != 0 && entry.method != 8) {
+        err = "unsupported compression method " + std::to_string(entry.method);
+        return nullptr;
+    }
+    const uint64_t hdr = entry.header_offset;
+    if (hdr > _file_size - 30 || load_le<uint32_t>(_data + hdr) != 0x04034b50) {
+        err = "bad local file header";
+        return nullptr;
+    }
+    const uint64_t start = hdr + 30 + load_le<uint16_t>(_data + hdr + 26) +
+        load_le<uint16_t>(_data + hdr + 28);
+    if (start > _file_size || entry.compressed_size > _file_size - start) {
+        err = "truncated entry";
+        return nullptr;
+    }
+    return _data + start;
+}
+
+const NpzReader::ArrayInfo& NpzReader::info(const std::string& key) {
+    Entry& entry = _entry(key);
+    if (entry.has_info) return entry.info;
+
+    // .npy header: magic, version, header length, then a Python dict literal
+    // e.g. {'descr': '<f8', 'fortran_order': False, 'shape': (6890, 3), }
+    EntryStream stream(_entry_data(entry), entry.compressed_size, entry.method);
+    unsigned char prefix[12];
+    if (!stream.read(prefix, 8) || std::memcmp(prefix, "\x93NUMPY", 6))
+        _error("array '" + key + "' is not a .npy array");
+    const size_t len_bytes = prefix[6] == 1 ? 2 : 4;
+    if (!stream.read(prefix + 8, len_bytes)) _error("truncated array '" + key + "'");
+    const size_t header_len = len_bytes == 2 ? load_le<uint16_t>(prefix + 8) :
+        load_le<uint32_t>(prefix + 8);
+    std::string header(header_len, '\0');
+    if (!stream.read(&header[0], header_len)) _error("truncated array '" + key + "'");
+    entry.data_offset = 8 + len_bytes + header_len;
+
+    const auto bad_header = [&]() {
+        _error("unsupported .npy header for array '" + key + "': " + header);
+    };
+    const auto field = [&](const char* name) {
+        size_t pos = header.find(name);
+        if (pos == std::string::npos) bad_header();
+        pos = header.find(':', pos);
+        if (pos == std::string::npos) bad_header();
+        return header.find_first_not_of(' ', pos + 1);
+    };
+    ArrayInfo& info = entry.info;
+
+    // Type, e.g. '<f8'; structured types (lists) are not supported
+    const size_t descr = field("'descr'");
+    if (descr == std::string::npos || header[descr] != '\'') bad_header();
+    const size_t descr_end = header.find('\'', descr + 1);
+    if (descr_end == std::string::npos || descr_end < descr + 4) bad_header();
+    const char byte_order = header[descr + 1], kind = header[descr + 2];
+    info.word_size = std::strtoul(header.c_str() + descr + 3, nullptr, 10);
+    if (byte_order == '>' && info.word_size > 1 && kind != 'S')
+        _error("big-endian array '" + key + "' is not supported");
+    switch (kind) {
+        case 'f':
+            if (info.word_size == 4) info.dtype = DType::f32;
+            else if (info.word_size == 8) info.dtype = DType::f64;
+            else bad_header();
+            break;
+        case 'i':
+            if (info.word_size == 4) info.dtype = DType::i32;
+            else if (info.word_size == 8) info.dtype = DType::i64;
+            else bad_header();
+            break;
+        case 'u':
+        case 'b':
+            if (info.word_size == 1) info.dtype = DType::u8;
+            else if (kind == 'u' && info.word_size == 4) info.dtype = DType::u32;
+            else if (kind == 'u' && info.word_size == 8) info.dtype = DType::u64;
+            else bad_header();
+            break;
+        case 'S': info.dtype = DType::bytes; break;
+        case 'U':
+            // UCS-4 characters
+            info.dtype = DType::unicode;
+            info.word_size *= 4;
+            break;
+        default: bad_header();
+    }
+    if (info.word_size == 0) bad_header();
+
+    const size_t fortran = field("'fortran_order'");
+    info.fortran_order = header.compare(fortran, 4, "True") == 0;
+
+    const size_t shape = field("'shape'");
+    const size_t shape_end = header.find(')', shape);
+    if (shape == std::string::npos || header[shape] != '(' ||
+            shape_end == std::string::npos) bad_header();
+    info.shape.clear();
+    for (const char* s = header.c_str() + shape + 1; s < header.c_str() + shape_end; ) {
+        if (*s >= '0' && *s <= '9') {
+            char* end;
+            info.shape.push_back(std::strtoull(s, &end, 10));
+            s = end;
+        } else {
+            ++s;
+        }
+    }
+    if (entry.data_offset + info.numel() * info.word_size != entry.size)
+        _error("bad size for array '" + key + "'");
+    entry.has_info = true;
+    return info;
+}
+
+void NpzReader::_add(const std::string& key, std::initializer_list<size_t> shape,
+        void* dst, Target target, size_t rows, size_t cols,
+        size_t row_stride, size_t col_stride, size_t row_begin, bool partial) {
+    const ArrayInfo& arr = info(key);
+    if (arr.dtype == DType::bytes || arr.dtype == DType::unicode)
+        _error("array '" + key + "' is not numeric");
+    bool shape_ok = arr.shape.size() == shape.size();
+    size_t i = 0;
+    for (size_t dim : shape) {
+        if (!shape_ok) break;
+        shape_ok = dim == ANY_DIM || arr.shape[i] == dim;
+        ++i;
+    }
+    // Matrix view of the array
+    size_t view_rows = 1, view_cols = 1;
+    if (arr.shape.size() == 1) {
+        view_rows = arr.shape[0];
+        // Allow 1-D arrays to be read into row vectors
+        if (rows == 1 && !partial) std::swap(view_rows, view_cols);
+    } else if (arr.shape.size() > 1) {
+        view_cols = arr.shape.back();
+        for (size_t j = 0; j + 1 < arr.shape.size(); ++j) view_rows *= arr.shape[j];
+    }
+    const bool rows_ok = partial ? row_begin <= view_rows && rows <= view_rows - row_begin :
+        view_rows == rows;
+    if (!shape_ok || !rows_ok || view_cols != cols) {
+        std::string actual;
+        for (size_t dim : arr.shape) actual += (actual.empty() ? "" : ", ") + std::to_string(dim);
+        _error("unexpected shape (" + actual + ") for array '" + key + "'");
+    }
+    Entry& entry = _entry(key);
+    if (partial && entry.method == 8 && !entry.index) entry.index.reset(new SeekIndex());
+    _requests.push_back({&entry, dst, target, rows, cols, row_stride, col_stride, row_begin});
+}
+
+std::string NpzReader::_read(const Request& req) const {
+    const Entry& entry = *req.entry;
+    const ArrayInfo& info = entry.info;
+    std::string err;
+    const unsigned char* data = _entry_data(entry, err);
+    if (!data) return err;
+    EntryStream stream(data, entry.compressed_size, entry.method, entry.index.get());
+    const size_t view_rows = req.cols ? info.numel() / req.cols : 0;
+    const bool same_type = (req.target == Target::f32 && info.dtype == DType::f32) ||
+        (req.target == Target::f64 && info.dtype == DType::f64) ||
+        (req.target == Target::u32 && info.dtype == DType::u32);
+
+    // Read numel elements starting at element offset in the file to dst
+    // element dst_offset onward, where inner is the index in the file
+    // varying fastest
+    const auto read_segment = [&](size_t offset, size_t numel, size_t dst_offset,
+            size_t inner_n, size_t inner_stride, size_t outer_stride) {
+        if (!stream.seek(entry.data_offset + offset * info.word_size)) return false;
+        if (same_type && inner_stride == 1 && (outer_stride == inner_n || numel <= inner_n)) {
+            // Inflate directly into destination
+            return stream.read(static_cast<char*>(req.dst) + dst_offset * info.word_size,
+                    numel * info.word_size);
+        }
+        switch (req.target) {
+            case Target::f32:
+                return read_converted(stream, info, numel,
+                        static_cast<float*>(req.dst) + dst_offset,
+                        inner_n, inner_stride, outer_stride);
+            case Target::f64:
+                return read_converted(stream, info, numel,
+                        static_cast<double*>(req.dst) + dst_offset,
+                        inner_n, inner_stride, outer_stride);
+            default:
+                return read_converted(stream, info, numel,
+                        static_cast<uint32_t*>(req.dst) + dst_offset,
+                        inner_n, inner_stride, outer_stride);
+        }
+    };
+
+    bool ok = true;
+    if (!info.fortran_order) {
+        // Rows are contiguous in the file
+        ok = read_segment(req.row_begin * req.cols, req.rows * req.cols, 0,
+                req.cols, req.col_stride, req.row_stride);
+    } else if (req.rows == view_rows) {
+        ok = read_segment(0, req.rows * req.cols, 0,
+                req.rows, req.row_stride, req.col_stride);
+    } else {
+        // Columns are contiguous in the file, read part of each
+        for (size_t c = 0; c < req.cols && ok; ++c) {
+            ok = read_segment(c * view_rows + req.row_begin, req.rows, c * req.col_stride,
+                    req.rows, req.row_stride, 0);
+        }
+    }
+    return ok ? std::string() : "corrupt or truncated entry";
+}
+
+void NpzReader::read() {
+    // Start with the largest arrays for better load balance
+    std::vector<const Request*> order;
+    for (const Request& req : _requests) order.push_back(&req);
+    std::sort(order.begin(), order.end(), [](const Request* a, const Request* b) {
+        return a->entry->size > b->entry->size;
+    });
+    // Errors are reported after all reads finished, on this thread:
+    // exiting from a pool worker would join the pool from inside it
+    std::vector<std::string> errors(order.size());
+    parallel_for(0, order.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) errors[i] = _read(*order[i]);
+    });
+    _requests.clear();
+    for (const std::string& err : errors) {
+        if (!err.empty()) _error(err);
+    }
+}
+
+double NpzReader::read_scalar(const std::string& key) {
+    const ArrayInfo& arr = info(key);
+    if (arr.numel() != 1 || arr.dtype == DType::bytes || arr.dtype == DType::unicode)
+        _error("array '" + key + "' is not a scalar");
+    double value;
+    const std::string err = _read({&_entry(key), &value, Target::f64, 1, 1, 1, 1, 0});
+    if (!err.empty()) _error(err);
+    return value;
+}
+
+std::string NpzReader::read_string(const std::string& key) {
+    const ArrayInfo& arr = info(key);
+    if (arr.dtype != DType::bytes && arr.dtype != DType::unicode)
+        _error("array '" + key + "' is not a string");
+    const Entry& entry = _entry(key);
+    EntryStream stream(_entry_data(entry), entry.compressed_size, entry.method);
+    std::string data(entry.size, '\0');
+    if (!stream.read(&data[0], entry.size)) _error("corrupt or truncated entry");
+    data.erase(0, entry.data_offset);
+    if (arr.dtype == DType::unicode) {
+        for (size_t i = 0; i * 4 < data.size(); ++i) data[i] = data[i * 4];
+        data.resize(data.size() / 4);
+    }
+    return data.substr(0, data.find('\0'));
+}
+
+void NpzReader::_error(const std::string& msg) const {
+    std::cerr << "ERROR: Invalid npz file '" << _path << "': " << msg << "\n";
+    std::exit(1);
+}
+
+}  // namespace internal
+}  // namespace smplx
@@ -1,15 +1,27 @@
 #include "smplx/sequence.hpp"
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
-#include <cnpy.h>
 #include "smplx/util.hpp"
-#include "smplx/util_cnpy.hpp"
+#include "smplx/internal/lbs.hpp"
+#include "smplx/internal/npz_reader.hpp"
+#include "smplx/internal/thread_pool.hpp"
 
 namespace smplx {
 
 namespace {
-using util::assert_shape;
+// Parameter accessors of Body<ModelConfig> over a parameter vector, to fill
+// parameters with SequenceModelSpec without constructing a Body
+template<class ModelConfig>
+struct BodyParams {
+    Vector& params;
+    auto trans() { return params.template head<3>(); }
+    auto pose() {
+        return params.template segment<ModelConfig::n_explicit_joints() * 3>(3);
+    }
+    auto shape() { return params.template tail<ModelConfig::n_shape_blends()>(); }
+};
 }  // namespace
 
 // AMASS npz structure
@@ -35,6 +47,19 @@ Sequence<SequenceConfig>::Sequence(const std::string& path) {
 
 template<class SequenceConfig>
 bool Sequence<SequenceConfig>::load(const std::string& path) {
+    if (!open(path)) return false;
+    read_frames(0, n_frames);
+    _npz.reset();
+    return true;
+}
+
+template<class SequenceConfig>
+bool Sequence<SequenceConfig>::open(const std::string& path) {
+    _npz.reset();
+    frame_begin = 0;
+    trans.resize(0, 3);
+    pose.resize(0, SequenceConfig::n_pose_params());
+    dmpls.resize(0, SequenceConfig::n_dmpls());
     if (!std::ifstream(path)) {
         n_frames = 0;
         gender = Gender::unknown;
@@ -43,33 +68,16 @@ bool Sequence<SequenceConfig>::load(const std::string& path) {
         return false;
     }
     // ** READ NPZ **
-    cnpy::npz_t npz = cnpy::npz_load(path);
-
-    _SMPLX_ASSERT_EQ(npz.count("trans"), 1);
-    auto& trans_raw = npz["trans"];
-    assert_shape(trans_raw, {util::ANY_SHAPE, 3});
-    n_frames = trans_raw.shape[0];
-    trans = util::load_float_matrix(trans_raw, n_frames, 3);
-
-    _SMPLX_ASSERT_EQ(npz.count("poses"), 1);
-    auto& poses_raw = npz["poses"];
-    assert_shape(poses_raw, {n_frames, SequenceConfig::n_pose_params()});
-    pose = util::load_float_matrix(poses_raw, n_frames, SequenceConfig::n_pose_params());
-
-    _SMPLX_ASSERT_EQ(npz.count("betas"), 1);
-    auto& shape_raw = npz["betas"];
-    assert_shape(shape_raw, {SequenceConfig::n_shape_params()});
-    shape = util::load_float_matrix(poses_raw, SequenceConfig::n_shape_params(), 1);
-
-    if (SequenceConfig::n_dmpls()) {
-        _SMPLX_ASSERT_EQ(npz.count("dmpls"), 1);
-        auto& dmpls_raw = npz["dmpls"];
-        assert_shape(dmpls_raw, {n_frames, SequenceConfig::n_dmpls()});
-        dmpls = util::load_float_matrix(poses_raw, n_frames, SequenceConfig::n_dmpls());
-    }
+    _npz = std::make_shared<internal::NpzReader>(path);
+    internal::NpzReader& npz = *_npz;
+
+    n_frames = npz.shape("trans")[0];
+    npz.add("betas", {SequenceConfig::n_shape_params()}, shape);
+    npz.read();
 
-    if (npz.count("gender")) {
-        char gender_spec = npz["gender"].data_holder[0];
+    if (npz.has("gender")) {
+        const std::string gender_str = npz.read_string("gender");
+        char gender_spec = gender_str.empty() ? '\0' : gender_str[0];
         gender = gender_spec == 'f' ? Gender::female :
                  gender_spec == 'm' ? Gender::male :
                  gender_spec == 'n' ? Gender::neutral :
@@ -81,12 +89,8 @@ bool Sequence<SequenceConfig>::load(const std::string& path) {
         gender = Gender::neutral;
     }
 
-    if (npz.count("mocap_framerate")) {
-        auto& mocap_frate_raw = npz["mocap_framerate"];
-        if (mocap_frate_raw.word_size == 8)
-            frame_rate = *mocap_frate_raw.data<double>();
-        else if (mocap_frate_raw.word_size == 4)
-            frame_rate = *mocap_frate_raw.data<float>();
+    if (npz.has("mocap_framerate")) {
+        frame_rate = npz.read_scalar("mocap_framerate");
     } else {
         // Reasonable default
         std::cerr << "WARNING: mocap_framerate not present in '" <<
@@ -96,7 +100,119 @@ bool Sequence<SequenceConfig>::load(const std::string& path) {
     return true;
 }
 
+template<class SequenceConfig>
+void Sequence<SequenceConfig>::read_frames(size_t begin, size_t count, int fields) {
+    _SMPLX_ASSERT(_npz != nullptr);
+    _SMPLX_ASSERT(begin <= n_frames && count <= n_frames - begin);
+    internal::NpzReader& npz = *_npz;
+    frame_begin = begin;
+
+    trans.resize(fields & TRANS ? count : 0, 3);
+    if (fields & TRANS) npz.add_rows("trans", {n_frames, 3}, begin, trans);
+
+    pose.resize(fields & POSE ? count : 0, SequenceConfig::n_pose_params());
+    if (fields & POSE) {
+        npz.add_rows("poses", {n_frames, SequenceConfig::n_pose_params()}, begin, pose);
+    }
+
+    dmpls.resize(fields & DMPLS ? count : 0, SequenceConfig::n_dmpls());
+    if (SequenceConfig::n_dmpls() && (fields & DMPLS)) {
+        npz.add_rows("dmpls", {n_frames, SequenceConfig::n_dmpls()}, begin, dmpls);
+    }
+    npz.read();
+}
+
+template<class SequenceConfig>
+template<class ModelConfig>
+void Sequence<SequenceConfig>::evaluate(const Model<ModelConfig>& model,
+        Scalar* out_verts, Scalar* out_joints, size_t begin, size_t count,
+        bool enable_pose_blendshapes) const {
+    using Spec = internal::SequenceModelSpec<SequenceConfig, ModelConfig>;
+    constexpr size_t n_verts = ModelConfig::n_verts();
+    constexpr size_t n_joints = ModelConfig::n_joints();
+    _SMPLX_ASSERT(begin >= frame_begin);
+    _SMPLX_ASSERT(begin - frame_begin + count <= size_t(trans.rows()) &&
+            begin - frame_begin + count <= size_t(pose.rows()));
+    // Frames are processed in blocks, bounding the memory used
+    constexpr size_t BLOCK_FRAMES = 64;
+
+    // Parameters of each frame, laid out as in Body
+    Vector frame_params = Vector::Zero(model.n_params());
+    BodyParams<ModelConfig> body{frame_params};
+    Spec::set_shape(*this, body);
+
+    // Shape blend shapes and joint regressor, once for the whole sequence
+    Points verts_shape_only(n_verts, 3);
+    internal::shape_blend_shapes<ModelConfig>(model,
+            Eigen::Map<const MatrixColMajor>(body.shape().data(),
+                ModelConfig::n_shape_blends(), 1),
+            Eigen::Map<MatrixColMajor>(verts_shape_only.data(), 3 * n_verts, 1));
+    Points joints_shaped(n_joints, 3);
+    joints_shaped.noalias() = model.joint_reg * verts_shape_only;
+    Eigen::Map<const Vector> verts_shape_only_flat(verts_shape_only.data(), 3 * n_verts);
+
+    const size_t max_block = std::min(BLOCK_FRAMES, count);
+    Matrix params(max_block, model.n_params());
+    MatrixColMajor pose_blend_params(ModelConfig::n_pose_blends(), max_block);
+    MatrixColMajor verts_shaped(3 * n_verts, max_block);
+    MatrixColMajor pose_latent;
+    internal::JointTransforms joint_transforms(max_block * n_joints, 12);
+    for (size_t block = 0; block < count; block += BLOCK_FRAMES) {
+        const size_t n_block = std::min(BLOCK_FRAMES, count - block);
+        for (size_t i = 0; i < n_block; ++i) {
+            Spec::set_pose(*this, body, begin - frame_begin + block + i);
+            params.row(i).noalias() = frame_params.transpose();
+        }
+
+        // Local joint rotations and pose blend shape params
+        internal::parallel_for(0, n_block, 1, [&](size_t i_begin, size_t i_end) {
+            for (size_t i = i_begin; i < i_end; ++i) {
+                internal::params_to_local_transforms<ModelConfig>(model,
+                        params.row(i).transpose(),
+                        joint_transforms.middleRows(i * n_joints, n_joints),
+                        pose_blend_params.col(i).data());
+            }
+        });
+
+        // Pose blend shapes of all frames of the block at once (GEMM)
+        auto block_verts_shaped = verts_shaped.leftCols(n_block);
+        block_verts_shaped.colwise() = verts_shape_only_flat;
+        if (enable_pose_blendshapes) {
+            internal::pose_blend_shapes<ModelConfig>(model,
+                    pose_blend_params.leftCols(n_block), block_verts_shaped,
+                    block_verts_shaped, pose_latent);
+        }
+
+        // Kinematics and LBS, multithreaded over frames, into the outputs
+        internal::parallel_for(0, n_block, 1, [&](size_t i_begin, size_t i_end) {
+            Points joints_scratch(out_joints ? 0 : n_joints, 3);
+            for (size_t i = i_begin; i < i_end; ++i) {
+                const size_t frame = block + i;
+                Eigen::Map<Points> joints_out(out_joints ?
+                        out_joints + frame * 3 * n_joints : joints_scratch.data(),
+                        n_joints, 3);
+                auto frame_joint_transforms =
+                    joint_transforms.middleRows(i * n_joints, n_joints);
+                internal::local_to_global<ModelConfig>(
+                        params.row(i).template head<3>().transpose(), joints_shaped,
+                        frame_joint_transforms, joints_out);
+                internal::lbs<ModelConfig>(model, frame_joint_transforms,
+                        Eigen::Map<const Points>(verts_shaped.col(i).data(), n_verts, 3),
+                        Eigen::Map<Points>(out_verts + frame * 3 * n_verts, n_verts, 3));
+            }
+        });
+    }
+}
+
 // Instantiation
 template class Sequence<sequence_config::AMASS>;
+template void Sequence<sequence_config::AMASS>::evaluate<model_config::SMPL>(
+        const Model<model_config::SMPL>&, Scalar*, Scalar*, size_t, size_t, bool) const;
+template void Sequence<sequence_config::AMASS>::evaluate<model_config::SMPLH>(
+        const Model<model_config::SMPLH>&, Scalar*, Scalar*, size_t, size_t, bool) const;
+template void Sequence<sequence_config::AMASS>::evaluate<model_config::SMPLX>(
+        const Model<model_config::SMPLX>&, Scalar*, Scalar*, size_t, size_t, bool) const;
+template void Sequence<sequence_config::AMASS>::evaluate<model_config::SMPLXpca>(
+        const Model<model_config::SMPLXpca>&, Scalar*, Scalar*, size_t, size_t, bool) const;
 
 }
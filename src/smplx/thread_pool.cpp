@@ -0,0 +1,132 @@
+#include "smplx/internal/thread_pool.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#include "smplx/util.hpp"
+
+namespace smplx {
+namespace internal {
+
+ThreadPool::ThreadPool(size_t n_threads) {
+    _start(n_threads);
+}
+
+ThreadPool::~ThreadPool() {
+    _stop();
+}
+
+void ThreadPool::resize(size_t n_threads) {
+    if (n_threads == size()) return;
+    _stop();
+    _start(n_threads);
+}
+
+void ThreadPool::_start(size_t n_threads) {
+    _stopping = false;
+    for (size_t i = 1; i < n_threads; ++i) {
+        _threads.emplace_back(&ThreadPool::_worker, this);
+    }
+}
+
+void ThreadPool::_stop() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _cv_work.notify_all();
+    for (auto& thd : _threads) thd.join();
+    _threads.clear();
+}
+
+void ThreadPool::_run(Job& job) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        job.next_job = _jobs;
+        _jobs = &job;
+        ++job.n_active;
+    }
+    _cv_work.notify_all();
+    _work_on(job);
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _unlink(job);
+    --job.n_active;
+    // Wait for helpers still executing chunks of this job
+    _cv_done.wait(lock, [&job]{ return job.n_active == 0; });
+}
+
+void ThreadPool::_work_on(Job& job) {
+    while (true) {
+        const size_t chunk_begin = job.begin +
+            job.next.fetch_add(1, std::memory_order_relaxed) * job.chunk;
+        if (chunk_begin >= job.end) break;
+        job.fn(job.ctx, chunk_begin, std::min(chunk_begin + job.chunk, job.end));
+    }
+}
+
+void ThreadPool::_unlink(Job& job) {
+    for (Job** it = &_jobs; *it; it = &(*it)->next_job) {
+        if (*it == &job) {
+            *it = job.next_job;
+            return;
+        }
+    }
+}
+
+void ThreadPool::_worker() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+        _cv_work.wait(lock, [this]{ return _stopping || _jobs != nullptr; });
+        if (_stopping) return;
+        Job& job = *_jobs;
+        ++job.n_active;
+        lock.unlock();
+        _work_on(job);
+        lock.lock();
+        // No chunks left, so stop handing this job out
+        _unlink(job);
+        if (--job.n_active == 0) _cv_done.notify_all();
+    }
+}
+
+namespace {
+// Default pool size: SMPLX_NUM_THREADS, else OMP_NUM_THREADS (often set to 1
+// when running one process per core), else the number of CPUs the process
+// may run on (respecting taskset/cgroup CPU sets on Linux)
+size_t default_num_threads() {
+    for (const char* var : {"SMPLX_NUM_THREADS", "OMP_NUM_THREADS"}) {
+        const char* env = std::getenv(var);
+        if (env && std::atoi(env) > 0) return std::atoi(env);
+    }
+#ifdef __linux__
+    cpu_set_t cpus;
+    if (sched_getaffinity(0, sizeof(cpus), &cpus) == 0 && CPU_COUNT(&cpus) > 0)
+        return CPU_COUNT(&cpus);
+#endif
+    return std::max(std::thread::hardware_concurrency(), 1u);
+}
+}  // namespace
+
+ThreadPool& thread_pool() {
+    static ThreadPool pool(default_num_threads());
+    return pool;
+}
+
+}  // namespace internal
+
+namespace util {
+
+void set_num_threads(size_t n_threads) {
+    internal::thread_pool().resize(std::max<size_t>(n_threads, 1));
+}
+
+size_t get_num_threads() {
+    return internal::thread_pool().size();
+}
+
+}  // namespace util
+}  // namespace smplx
@@ -0,0 +1,189 @@
+#include "smplx/internal/uv_map.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "smplx/internal/model_file.hpp"
+
+namespace smplx {
+namespace internal {
+
+namespace {
+// Parsed UV map with its storage
+struct OwnedUVMap {
+    UVMap map;
+    std::vector<Scalar> uv;
+    std::vector<Index> triangles;
+};
+
+[[noreturn]] void uv_error(const std::string& source, const std::string& msg) {
+    std::cerr << "ERROR: Invalid UV map '" << source << "': " << msg << "\n";
+    std::exit(1);
+}
+
+// Number parsing on a character range, independent of the C/C++ locale
+// (streams and strtof would read "0,5" as 0.5 in some locales, and are slow)
+const char* skip_space(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) ++p;
+    return p;
+}
+
+bool parse_uint(const char*& p, const char* end, uint64_t& out) {
+    p = skip_space(p, end);
+    if (p == end || *p < '0' || *p > '9') return false;
+    out = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; ++p) out = out * 10 + uint64_t(*p - '0');
+    return true;
+}
+
+bool parse_float(const char*& p, const char* end, Scalar& out) {
+    p = skip_space(p, end);
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) negative = *p++ == '-';
+    // Decimal significand; digits past 19 only affect the exponent
+    uint64_t mantissa = 0;
+    int exponent = 0, n_digits = 0, n_sig = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; ++p, ++n_digits) {
+        if (n_sig < 19) {
+            mantissa = mantissa * 10 + uint64_t(*p - '0');
+            if (mantissa) ++n_sig;
+        } else {
+            ++exponent;
+        }
+    }
+    if (p < end && *p == '.') {
+        for (++p; p < end && *p >= '0' && *p <= '9'; ++p, ++n_digits) {
+            if (n_sig < 19) {
+                mantissa = mantissa * 10 + uint64_t(*p - '0');
+                if (mantissa) ++n_sig;
+                --exponent;
+            }
+        }
+    }
+    if (!n_digits) return false;
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        ++p;
+        bool exp_negative = false;
+        if (p < end && (*p == '-' || *p == '+')) exp_negative = *p++ == '-';
+        uint64_t exp_value;
+        if (!parse_uint(p, end, exp_value)) return false;
+        exponent += exp_negative ? -int(std::min<uint64_t>(exp_value, 1000)) :
+            int(std::min<uint64_t>(exp_value, 1000));
+    }
+    static const double POW10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8,
+        1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20,
+        1e21, 1e22};
+    double value = static_cast<double>(mantissa);
+    if (exponent >= -22 && exponent <= 22) {
+        value = exponent < 0 ? value / POW10[-exponent] : value * POW10[exponent];
+    } else {
+        value *= std::pow(10.0, exponent);
+    }
+    out = static_cast<Scalar>(negative ? -value : value);
+    return true;
+}
+
+std::shared_ptr<const UVMap> map_uv_sidecar(const std::string& path) {
+    size_t size;
+    std::shared_ptr<const void> mapped = map_file(path, size);
+    ModelFileView file(mapped.get(), size, path);
+    const size_t ANY = ModelFileView::ANY_DIM;
+    if (!file.find("uv") || !file.find("uv_triangles")) uv_error(path, "no UV map in file");
+    auto uv_map = std::make_shared<UVMap>();
+    uv_map->n_uv_verts = file.find("uv")->shape[0];
+    uv_map->n_faces = file.find("uv_triangles")->shape[0];
+    uv_map->uv = file.get<Scalar>("uv", DType::f32, {ANY, 2});
+    uv_map->triangles = file.get<Index>("uv_triangles", DType::u32, {ANY, 3});
+    uv_map->storage = std::move(mapped);
+    return uv_map;
+}
+}  // namespace
+
+std::shared_ptr<const UVMap> parse_uv_map(const char* data, size_t size,
+        const std::string& source) {
+    const char* p = data;
+    const char* end = data + size;
+    uint64_t n_uv_verts;
+    if (!parse_uint(p, end, n_uv_verts)) uv_error(source, "missing number of UV vertices");
+
+    auto owned = std::make_shared<OwnedUVMap>();
+    // 0 UV vertices: no UV map (placeholder file)
+    if (n_uv_verts == 0) return std::shared_ptr<const UVMap>(owned, &owned->map);
+    owned->uv.resize(2 * n_uv_verts);
+    for (Scalar& x : owned->uv) {
+        if (!parse_float(p, end, x)) uv_error(source, "bad or missing UV coordinates");
+    }
+    // Faces until end of file (or other trailing content)
+    uint64_t idx;
+    while (parse_uint(p, end, idx)) {
+        if (idx == 0 || idx > n_uv_verts) uv_error(source, "UV index out of range");
+        owned->triangles.push_back(static_cast<Index>(idx - 1));
+    }
+    if (owned->triangles.size() % 3) uv_error(source, "bad UV triangles");
+
+    owned->map.uv = owned->uv.data();
+    owned->map.n_uv_verts = n_uv_verts;
+    owned->map.triangles = owned->triangles.data();
+    owned->map.n_faces = owned->triangles.size() / 3;
+    return std::shared_ptr<const UVMap>(owned, &owned->map);
+}
+
+std::shared_ptr<const UVMap> load_uv_map(const std::string& path) {
+    static std::mutex mutex;
+    static std::unordered_map<std::string, std::weak_ptr<const UVMap>> cache;
+    if (path.empty()) return nullptr;
+    const double mtime = file_mtime(path);
+    if (mtime < 0) return nullptr;
+
+    static const std::string BIN_EXT = ".smplxbin";
+    const bool is_binary = path.size() >= BIN_EXT.size() &&
+        path.compare(path.size() - BIN_EXT.size(), BIN_EXT.size(), BIN_EXT) == 0;
+    const std::string sidecar = is_binary ? path : uv_map_sidecar_path(path);
+    const bool use_sidecar = is_binary || file_mtime(sidecar) >= mtime;
+    const std::string& load_path = use_sidecar ? sidecar : path;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::shared_ptr<const UVMap> uv_map = cache[load_path].lock();
+    if (uv_map) return uv_map;
+    if (use_sidecar) {
+        uv_map = map_uv_sidecar(load_path);
+    } else if (std::ifstream(load_path, std::ios::binary | std::ios::ate).tellg() <= 0) {
+        // Empty file (cannot be mapped): no UV map
+        uv_map = std::make_shared<const UVMap>();
+    } else {
+        size_t size;
+        std::shared_ptr<const void> mapped = map_file(load_path, size);
+        uv_map = parse_uv_map(static_cast<const char*>(mapped.get()), size, load_path);
+    }
+    // Drop entries of maps no longer in use
+    for (auto it = cache.begin(); it != cache.end();) {
+        it = it->second.expired() ? cache.erase(it) : std::next(it);
+    }
+    cache[load_path] = uv_map;
+    return uv_map;
+}
+
+void save_uv_map(const UVMap& uv_map, const std::string& path) {
+    ModelFileWriter file;
+    file.add("uv", DType::f32, {uv_map.n_uv_verts, 2}, uv_map.uv);
+    file.add("uv_triangles", DType::u32, {uv_map.n_faces, 3}, uv_map.triangles);
+    file.write(path, "uv");
+}
+
+std::string uv_map_sidecar_path(const std::string& path) {
+    const size_t dot = path.find_last_of('.');
+    const size_t slash = path.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+        return path + ".smplxbin";
+    return path.substr(0, dot) + ".smplxbin";
+}
+
+}  // namespace internal
+}  // namespace smplx
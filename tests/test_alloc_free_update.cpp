@@ -0,0 +1,186 @@
+// Checks that steady-state Body::update (CPU) does not allocate:
+// counts heap allocations (operator new, and malloc on glibc, used by Eigen)
+// during a second update() and fails if there are any.
+// Uses a synthetic model written to a temporary .npz, so that the official
+// models are not required.
+// 1 optional argument: path of the temporary .npz, default test_model.npz
+#include "smplx/smplx.hpp"
+
+#include <zlib.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+std::atomic<bool> counting{false};
+std::atomic<long> n_allocs{0};
+inline void count_alloc() {
+    if (counting.load(std::memory_order_relaxed)) ++n_allocs;
+}
+}  // namespace
+
+#ifdef __GLIBC__
+// Eigen allocates with malloc, not operator new
+extern "C" {
+void* __libc_malloc(size_t);
+void __libc_free(void*);
+void* __libc_calloc(size_t, size_t);
+void* __libc_realloc(void*, size_t);
+void* __libc_memalign(size_t, size_t);
+void* malloc(size_t n) { count_alloc(); return __libc_malloc(n); }
+void* calloc(size_t n, size_t sz) { count_alloc(); return __libc_calloc(n, sz); }
+void* realloc(void* p, size_t n) { count_alloc(); return __libc_realloc(p, n); }
+int posix_memalign(void** p, size_t align, size_t n) {
+    count_alloc();
+    *p = __libc_memalign(align, n);
+    return *p ? 0 : ENOMEM;
+}
+}
+// operator new/delete use the glibc functions directly: the compiler knows
+// std::malloc/std::free, and would warn that they do not match new/delete
+inline void* raw_alloc(size_t n) { return __libc_malloc(n); }
+inline void raw_free(void* p) { __libc_free(p); }
+#else
+inline void* raw_alloc(size_t n) { return std::malloc(n); }
+inline void raw_free(void* p) { std::free(p); }
+#endif
+
+void* operator new(size_t n) {
+    count_alloc();
+    if (void* p = raw_alloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t n) { return operator new(n); }
+void operator delete(void* p) noexcept { raw_free(p); }
+void operator delete[](void* p) noexcept { raw_free(p); }
+void operator delete(void* p, size_t) noexcept { raw_free(p); }
+void operator delete[](void* p, size_t) noexcept { raw_free(p); }
+
+namespace {
+using namespace smplx;
+
+// Minimal writer of uncompressed .npz files (zip archives of .npy arrays)
+class NpzWriter {
+public:
+    template<class T>
+    void add(const std::string& key, const std::vector<T>& data,
+            const std::string& shape) {
+        const char* descr = sizeof(T) == 4 && T(0.5) != T(0) ? "<f4" : "<i4";
+        std::string header = std::string("{'descr': '") + descr +
+            "', 'fortran_order': False, 'shape': (" + shape + "), }";
+        header.resize(((header.size() + 11) / 64 + 1) * 64 - 11, ' ');
+        header += '\n';
+        std::string npy("\x93NUMPY\x01\x00", 8);
+        put(npy, uint16_t(header.size()));
+        npy += header;
+        npy.append(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(T));
+        _entries.push_back({key + ".npy", std::move(npy)});
+    }
+
+    void write(const std::string& path) const {
+        std::string out, cd;
+        for (const auto& entry : _entries) {
+            const std::string& name = entry.first;
+            const std::string& npy = entry.second;
+            const uint32_t crc = uint32_t(crc32(0, reinterpret_cast<const Bytef*>(npy.data()),
+                        uInt(npy.size())));
+            // Fields shared by local and central headers, from version needed
+            std::string common;
+            put(common, uint16_t(20)); put(common, uint16_t(0)); put(common, uint16_t(0));
+            put(common, uint32_t(0)); put(common, crc);
+            put(common, uint32_t(npy.size())); put(common, uint32_t(npy.size()));
+            put(common, uint16_t(name.size())); put(common, uint16_t(0));
+
+            put(cd, uint32_t(0x02014b50)); put(cd, uint16_t(20));
+            cd += common;
+            put(cd, uint16_t(0)); put(cd, uint16_t(0)); put(cd, uint16_t(0));
+            put(cd, uint32_t(0)); put(cd, uint32_t(out.size()));
+            cd += name;
+
+            put(out, uint32_t(0x04034b50));
+            out += common + name + npy;
+        }
+        const uint32_t cd_offset = uint32_t(out.size());
+        out += cd;
+        put(out, uint32_t(0x06054b50)); put(out, uint32_t(0));
+        put(out, uint16_t(_entries.size())); put(out, uint16_t(_entries.size()));
+        put(out, uint32_t(cd.size())); put(out, cd_offset); put(out, uint16_t(0));
+        std::ofstream(path, std::ios::binary).write(out.data(), out.size());
+    }
+
+private:
+    template<class T> static void put(std::string& out, T val) {
+        for (size_t i = 0; i < sizeof(T); ++i) out += char((val >> (8 * i)) & 0xFF);
+    }
+    std::vector<std::pair<std::string, std::string>> _entries;
+};
+
+// Write a random model with the dimensions of ModelConfig to path
+template<class ModelConfig>
+void write_model(const std::string& path) {
+    const size_t nv = ModelConfig::n_verts(), nf = ModelConfig::n_faces(),
+                 nj = ModelConfig::n_joints(), ns = ModelConfig::n_shape_blends(),
+                 np = ModelConfig::n_pose_blends();
+    const auto dims = [](size_t a, size_t b) {
+        return std::to_string(a) + ", " + std::to_string(b);
+    };
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<float> unif(-1.f, 1.f);
+    auto random_vec = [&](size_t n, float scale) {
+        std::vector<float> v(n);
+        for (float& x : v) x = unif(rng) * scale;
+        return v;
+    };
+    NpzWriter npz;
+    npz.add("v_template", random_vec(nv * 3, 1.f), dims(nv, 3));
+    std::vector<int32_t> faces(nf * 3);
+    for (auto& idx : faces) idx = int32_t(rng() % nv);
+    npz.add("f", faces, dims(nf, 3));
+    // Each joint the mean of a few vertices; each vertex skinned to one joint
+    std::vector<float> jreg(nj * nv, 0.f), weights(nv * nj, 0.f);
+    for (size_t j = 0; j < nj; ++j) {
+        for (int k = 0; k < 4; ++k) jreg[j * nv + rng() % nv] += 0.25f;
+    }
+    for (size_t i = 0; i < nv; ++i) weights[i * nj + i % nj] = 1.f;
+    npz.add("J_regressor", jreg, dims(nj, nv));
+    npz.add("weights", weights, dims(nv, nj));
+    npz.add("shapedirs", random_vec(nv * 3 * ns, 0.05f), dims(nv, 3) + ", " + std::to_string(ns));
+    npz.add("posedirs", random_vec(nv * 3 * np, 0.01f), dims(nv, 3) + ", " + std::to_string(np));
+    npz.write(path);
+}
+
+// Returns the number of allocations in the second update()
+template<class ModelConfig>
+long count_update_allocs(const std::string& path) {
+    write_model<ModelConfig>(path);
+    Model<ModelConfig> model(path);
+    Body<ModelConfig> body(model);
+    body.params.setRandom();
+    body.params *= 0.5f;
+    body.update(true);
+
+    body.pose()(3) += 0.1f;
+    n_allocs = 0;
+    counting = true;
+    body.update(true);
+    counting = false;
+    std::remove(path.c_str());
+    return n_allocs;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    const std::string path = argc > 1 ? argv[1] : "test_model.npz";
+    const long smpl_allocs = count_update_allocs<model_config::SMPL>(path);
+    const long smplx_allocs = count_update_allocs<model_config::SMPLX>(path);
+    std::printf("allocations in second Body::update: SMPL %ld, SMPL-X %ld\n",
+            smpl_allocs, smplx_allocs);
+    return smpl_allocs || smplx_allocs ? 1 : 0;
+}